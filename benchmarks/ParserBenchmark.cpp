@@ -0,0 +1,167 @@
+/*! \file ParserBenchmark.cpp
+ *  \brief Compares FeatureParser to the previous stream based parser of SpeechData::Load.
+ *
+ *  Build from the repository root:
+ *  g++ -std=c++17 -O2 -Iinclude benchmarks/ParserBenchmark.cpp $(find source -name '*.cpp' ! -name Main.cpp) -o parser_benchmark -pthread
+ *
+ *  Usage: parser_benchmark [output folder] [lines] [frames per line]
+ */
+
+#include "Common.h"
+
+#include "FeatureParser.h"
+#include "SpeechData.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double GetSeconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    /*! \brief Writes a text sample file with random features.
+     */
+    void Generate(const std::string& path, unsigned int lines, unsigned int frames, unsigned int dimensions)
+    {
+        std::ofstream file(path);
+
+        std::mt19937 generator(1);
+        std::normal_distribution<float> distribution(0.0f, 10.0f);
+
+        for (unsigned int l = 0; l < lines; ++l)
+        {
+            file << 100 + l % 10 << "_" << l / 10 + 1 << " ";
+
+            for (unsigned int f = 0; f < frames; ++f)
+            {
+                if (f > 0)
+                {
+                    file << ",";
+                }
+
+                for (unsigned int d = 0; d < dimensions; ++d)
+                {
+                    file << (d > 0 ? " " : "") << distribution(generator);
+                }
+            }
+
+            file << std::endl;
+        }
+    }
+
+    /*! \brief Parses a line the way SpeechData::Load did before FeatureParser.
+     */
+    void ParseReference(const std::string& line, std::vector<Real>& values)
+    {
+        std::stringstream ssFeatures(line);
+
+        std::string label;
+
+        if (!(ssFeatures >> label))
+        {
+            return;
+        }
+
+        std::string features;
+
+        while (std::getline(ssFeatures, features, ','))
+        {
+            std::stringstream ssFeature(features);
+            std::string feature;
+
+            while (std::getline(ssFeature, feature, ' '))
+            {
+                if (feature.size() > 0 && feature[0] != ' ')
+                {
+                    values.push_back(std::stof(feature));
+                }
+            }
+        }
+    }
+
+    void ParseFast(const std::string& line, std::vector<Real>& values, std::vector<Real>& frame)
+    {
+        FeatureParser parser(line);
+
+        std::string label;
+
+        if (!parser.ReadLabel(label))
+        {
+            return;
+        }
+
+        while (parser.ReadFrame<float>(frame))
+        {
+            values.insert(values.end(), frame.begin(), frame.end());
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string folder = (argc > 1) ? argv[1] : ".";
+    unsigned int lines = (argc > 2) ? std::stoi(argv[2]) : 200;
+    unsigned int frames = (argc > 3) ? std::stoi(argv[3]) : 300;
+
+    std::string path = GetSamplesPath(folder, 1);
+
+    Generate(path, lines, frames, 39);
+
+    std::vector<std::string> fileLines;
+
+    {
+        std::ifstream file(path);
+        std::string line;
+
+        while (std::getline(file, line))
+        {
+            fileLines.push_back(line);
+        }
+    }
+
+    std::cout << "File: " << path << ", " << GetFileSize(path) / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    std::vector<Real> referenceValues;
+    std::vector<Real> fastValues;
+    std::vector<Real> frame;
+
+    Clock::time_point start = Clock::now();
+
+    for (auto& line : fileLines)
+    {
+        ParseReference(line, referenceValues);
+    }
+
+    double referenceTime = GetSeconds(start);
+
+    start = Clock::now();
+
+    for (auto& line : fileLines)
+    {
+        ParseFast(line, fastValues, frame);
+    }
+
+    double fastTime = GetSeconds(start);
+
+    bool same = referenceValues.size() == fastValues.size()
+        && std::equal(referenceValues.begin(), referenceValues.end(), fastValues.begin());
+
+    std::cout << "Reference parser: " << referenceTime << " s" << std::endl;
+    std::cout << "FeatureParser: " << fastTime << " s (" << referenceTime / fastTime << "x)" << std::endl;
+    std::cout << "Values: " << fastValues.size() << (same ? ", identical." : ", DIFFERENT!") << std::endl;
+
+    // The whole loading path, including line indexing on the first call.
+    SpeechData data;
+
+    start = Clock::now();
+    data.Load(path, 1, lines, 1, true, 39);
+    double loadTime = GetSeconds(start);
+
+    data.Validate();
+
+    std::cout << "SpeechData::Load: " << loadTime << " s, " << data.GetTotalSampleCount() << " frames" << std::endl;
+
+    return same ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+/*! \file ScoringBenchmark.cpp
+ *  \brief Compares MixtureKernel to the previous per-cluster scoring of GMModel.
+ *
+ *  Build from the repository root, with -mavx2 -mfma or -march=native to enable the SIMD kernel:
+ *  g++ -std=c++17 -O2 -march=native -Iinclude benchmarks/ScoringBenchmark.cpp $(find source -name '*.cpp' ! -name Main.cpp) -o scoring_benchmark -pthread
+ *
+ *  Usage: scoring_benchmark [components] [dimensions] [frames]
+ */
+
+#include "Common.h"
+
+#include "MixtureKernel.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double GetSeconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    struct Component
+    {
+        std::vector<Real> means;
+        std::vector<Real> variances;
+        std::vector<Real> variancesInv;
+        Real weight;
+        Real pdfConstant;
+    };
+
+    /*! \brief Scores frames the way GMModel::GetLogLikelihood() did before MixtureKernel.
+     */
+    Real GetReferenceLogLikelihood(const FrameView& samples, const std::vector<Component>& components)
+    {
+        Real result = 0.0;
+        Real invN = 1.0 / static_cast<Real>(samples.GetFrameCount());
+
+        std::vector<Real> values(components.size());
+
+        for (unsigned int n = 0; n < samples.GetFrameCount(); ++n)
+        {
+            const Real* sample = samples[n];
+
+            Real probMax = -std::numeric_limits<Real>::infinity();
+
+            for (unsigned int c = 0; c < components.size(); ++c)
+            {
+                const Component& component = components[c];
+
+                Real v = 0.0;
+
+                for (unsigned int d = 0; d < samples.GetDimensionCount(); ++d)
+                {
+                    Real tmp = sample[d] - component.means[d];
+                    v += tmp * tmp * component.variancesInv[d];
+                }
+
+                values[c] = (component.pdfConstant - 0.5 * v) + std::log(component.weight);
+                probMax = Max(probMax, values[c]);
+            }
+
+            Real probSumExp = 0.0;
+
+            for (Real value : values)
+            {
+                probSumExp += std::exp(value - probMax);
+            }
+
+            result += (probMax + std::log(probSumExp)) * invN;
+        }
+
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int componentCount = (argc > 1) ? std::stoi(argv[1]) : 512;
+    unsigned int dimensionCount = (argc > 2) ? std::stoi(argv[2]) : 39;
+    unsigned int frameCount = (argc > 3) ? std::stoi(argv[3]) : 3000;
+
+    std::mt19937 generator(1);
+    std::normal_distribution<Real> normal(0.0, 1.0);
+    std::uniform_real_distribution<Real> uniform(0.5, 2.0);
+
+    FrameMatrix samples(dimensionCount);
+
+    for (unsigned int n = 0; n < frameCount; ++n)
+    {
+        Real* frame = samples.AddFrame();
+
+        for (unsigned int d = 0; d < dimensionCount; ++d)
+        {
+            frame[d] = normal(generator);
+        }
+    }
+
+    std::vector<Component> components(componentCount);
+
+    MixtureKernel kernel;
+    kernel.Resize(componentCount, dimensionCount);
+
+    for (unsigned int c = 0; c < componentCount; ++c)
+    {
+        Component& component = components[c];
+
+        component.weight = 1.0 / componentCount;
+        component.pdfConstant = static_cast<Real>(dimensionCount) * std::log(2.0f * PI_F);
+
+        for (unsigned int d = 0; d < dimensionCount; ++d)
+        {
+            component.means.push_back(normal(generator));
+            component.variances.push_back(uniform(generator));
+            component.variancesInv.push_back(1.0 / component.variances.back());
+
+            component.pdfConstant += std::log(component.variances.back());
+        }
+
+        component.pdfConstant *= -0.5;
+
+        kernel.SetComponent(c, component.means.data(), component.variances.data(), component.weight);
+    }
+
+    std::cout << "Components: " << componentCount << ", dimensions: " << dimensionCount
+              << ", frames: " << frameCount << ", kernel: " << MixtureKernel::GetInstructionSet() << std::endl;
+
+    Clock::time_point start = Clock::now();
+    Real reference = GetReferenceLogLikelihood(samples, components);
+    double referenceTime = GetSeconds(start);
+
+    start = Clock::now();
+    Real fast = kernel.GetLogLikelihood(samples);
+    double fastTime = GetSeconds(start);
+
+    Real difference = std::abs(reference - fast) / std::abs(reference);
+
+    std::cout << "Reference scoring: " << referenceTime << " s" << std::endl;
+    std::cout << "MixtureKernel: " << fastTime << " s (" << referenceTime / fastTime << "x)" << std::endl;
+    std::cout << "Log-likelihood: " << std::setprecision(12) << fast << ", relative difference " << difference << std::endl;
+
+    return (difference < 1.0e-9) ? 0 : 1;
+}
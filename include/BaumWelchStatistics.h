@@ -0,0 +1,86 @@
+#ifndef _BAUMWELCHSTATISTICS_H_
+#define _BAUMWELCHSTATISTICS_H_
+
+#include "Common.h"
+
+/*! \brief Baum-Welch sufficient statistics of frames against a Gaussian mixture.
+ *
+ *  For each component c the statistics hold the zeroth order N_c = sum(P(c|x_n)),
+ *  the first order F_c = sum(P(c|x_n) * x_n) and optionally the diagonal
+ *  second order S_c = sum(P(c|x_n) * x_n^2). They are computed once against a
+ *  background model, see GMModel::Accumulate(), and MAP adaptation with any
+ *  relevance factor is then a closed-form update, see GMModel::Adapt().
+ *  Statistics of several utterances of a speaker are combined with Add().
+ */
+class BaumWelchStatistics
+{
+public:
+    BaumWelchStatistics();
+
+    virtual ~BaumWelchStatistics();
+
+    /*! \brief Sets the shape of the statistics and clears them.
+     *
+     *  \param secondOrder True to accumulate the second order statistics.
+     */
+    void Resize(unsigned int componentCount, unsigned int dimensionCount, bool secondOrder = false);
+
+    /*! \brief Sets all statistics to zero.
+     */
+    void Clear();
+
+    /*! \brief Adds the statistics of other frames.
+     *
+     *  \note The shapes must match.
+     */
+    void Add(const BaumWelchStatistics& other);
+
+    /*! \brief Adds the posterior of a component for a frame.
+     */
+    void Accumulate(const Real* frame, unsigned int component, Real posterior);
+
+    /*! \brief Counts a frame and adds its log-likelihood.
+     */
+    void AddFrame(Real logLikelihood);
+
+    unsigned int GetComponentCount() const;
+
+    unsigned int GetDimensionCount() const;
+
+    bool HasSecondOrder() const;
+
+    unsigned int GetFrameCount() const;
+
+    /*! \brief Returns the total log-likelihood of the frames.
+     */
+    Real GetLogLikelihood() const;
+
+    Real GetZerothOrder(unsigned int component) const;
+
+    /*! \brief Returns GetDimensionCount() first order statistics of a component.
+     */
+    const Real* GetFirstOrder(unsigned int component) const;
+
+    /*! \brief Returns GetDimensionCount() second order statistics of a component.
+     *
+     *  \note Only valid if HasSecondOrder().
+     */
+    const Real* GetSecondOrder(unsigned int component) const;
+
+private:
+    unsigned int mComponentCount;
+
+    unsigned int mDimensionCount;
+
+    unsigned int mFrameCount;
+
+    Real mLogLikelihood;
+
+    std::vector<Real> mZerothOrder;
+
+    std::vector<Real> mFirstOrder;
+
+    std::vector<Real> mSecondOrder;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef _CENTROIDASSIGNMENT_H_
+#define _CENTROIDASSIGNMENT_H_
+
+#include "Common.h"
+
+#include "DynamicVector.h"
+#include "FrameMatrix.h"
+
+/*! \brief Assigns samples to their closest centroids over repeated refinement passes.
+ *
+ *  With bounds enabled this uses Hamerly's triangle inequality bounds. Each
+ *  sample keeps an upper bound of the distance to its centroid and a lower
+ *  bound of the distance to any other centroid, both moved by how far the
+ *  centroids moved since the previous pass. A sample is not compared with
+ *  the centroids if its upper bound is below the lower bound or below half
+ *  the distance from its centroid to the closest other centroid. Once the
+ *  centroids stabilize most samples are skipped. The other samples skip
+ *  the centroids that are further than twice the distance of the closest
+ *  centroid so far from it.
+ *
+ *  A sample is only skipped if its centroid is the unique closest one, so
+ *  the assignment always equals comparing every sample with every centroid
+ *  using DynamicVector::Distance(), with ties going to the lowest index.
+ */
+class CentroidAssignment
+{
+public:
+    CentroidAssignment();
+
+    virtual ~CentroidAssignment();
+
+    /*! \brief Enables or disables the bounds.
+     *
+     *  Disabling the bounds compares every sample with every centroid.
+     */
+    void SetBoundsEnabled(bool enabled);
+
+    bool IsBoundsEnabled() const;
+
+    /*! \brief Forgets the bounds, the next Assign() compares every sample with every centroid.
+     *
+     *  Must be called before Assign() is given different samples.
+     */
+    void Reset();
+
+    /*! \brief Assigns each sample to its closest centroid.
+     *
+     *  The bounds of the previous pass are reused if the sample and
+     *  centroid counts did not change.
+     *
+     *  \param centroids The centroids, only the first centroidCount are used.
+     *  \param indices The index of the closest centroid of each sample, resized if necessary.
+     *                 When the bounds are reused it must hold the result of the previous pass.
+     */
+    void Assign(const FrameView& samples, const std::vector< DynamicVector<Real> >& centroids,
+                unsigned int centroidCount, std::vector<unsigned int>& indices);
+
+    /*! \brief Returns the number of sample-centroid distances computed by the last Assign().
+     */
+    std::size_t GetDistanceCount() const;
+
+private:
+    /*! \brief Finds the closest centroid of a sample and sets its bounds.
+     *
+     *  Centroids further than twice the distance to the closest centroid so
+     *  far from it are skipped if the bounds are enabled.
+     *
+     *  \param candidate A centroid whose squared distance candidateDist is already known.
+     */
+    unsigned int Search(const Real* sample, const std::vector< DynamicVector<Real> >& centroids,
+                        unsigned int centroidCount, unsigned int candidate, Real candidateDist, unsigned int s);
+
+    /*! \brief Moves the bounds by how far the centroids moved since the previous pass.
+     */
+    void MoveBounds(const std::vector< DynamicVector<Real> >& centroids, const std::vector<unsigned int>& indices);
+
+    void UpdateCentroidDistances(const std::vector< DynamicVector<Real> >& centroids, unsigned int centroidCount);
+
+private:
+    bool mBoundsEnabled;
+
+    /*! \brief True if the bounds hold for the previous centroids.
+     */
+    bool mValid;
+
+    std::size_t mDistanceCount;
+
+    std::vector<Real> mUpperBounds;
+
+    std::vector<Real> mLowerBounds;
+
+    /*! \brief The distances between the centroids, row-major centroidCount x centroidCount.
+     */
+    std::vector<Real> mCentroidDistances;
+
+    /*! \brief Half the distance from each centroid to its closest other centroid.
+     */
+    std::vector<Real> mHalfDistances;
+
+    std::vector< DynamicVector<Real> > mPreviousCentroids;
+};
+
+#endif
@@ -24,6 +24,9 @@
 #include <iomanip>
 #include <functional>
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #define INDEXFIX
 //#undef INDEXFIX
 
@@ -225,6 +228,58 @@ inline Real Deviation(const std::vector<Real>& values, Real mean)
     return std::sqrt(Variance(values, mean));
 }
 
+/*! \brief Returns the quantile function of the standard normal distribution.
+ *
+ *  \algorithm Acklam's rational approximation refined with one step of Halley's method.
+ *  \param p Probability in range (0, 1).
+ */
+inline Real InverseNormalCDF(Real p)
+{
+    static const Real a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const Real b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+    static const Real c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const Real d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+
+    const Real low = 0.02425;
+
+    if (p <= 0.0)
+    {
+        return -std::numeric_limits<Real>::infinity();
+    }
+
+    if (p >= 1.0)
+    {
+        return std::numeric_limits<Real>::infinity();
+    }
+
+    Real x;
+
+    if (p < low)
+    {
+        Real q = std::sqrt(-2.0 * std::log(p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+
+    else if (p <= 1.0 - low)
+    {
+        Real q = p - 0.5;
+        Real r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+
+    else
+    {
+        Real q = std::sqrt(-2.0 * std::log(1.0 - p));
+        x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+
+    // Refinement to full precision.
+    Real e = 0.5 * std::erfc(-x / std::sqrt(2.0)) - p;
+    Real u = e * std::sqrt(2.0 * 3.14159265358979323846) * std::exp(x * x / 2.0);
+
+    return x - u / (1.0 + x * u / 2.0);
+}
+
 inline bool FileExists(const std::string& path)
 {
     std::ifstream file(path);
@@ -232,6 +287,45 @@ inline bool FileExists(const std::string& path)
     return file.good();
 }
 
+/*! \brief Returns the last modification time of a file.
+ *
+ *  Uses the nanosecond time stamp where available, so that a file rewritten
+ *  within the same second is still detected as modified.
+ *
+ *  \return The modification time in nanoseconds since epoch or 0 if the file does not exist.
+ */
+inline long long GetFileModificationTime(const std::string& path)
+{
+    struct stat info;
+
+    if (stat(path.c_str(), &info) != 0)
+    {
+        return 0;
+    }
+
+#if defined(_WIN32)
+    return static_cast<long long>(info.st_mtime) * 1000000000LL;
+#elif defined(__APPLE__)
+    return static_cast<long long>(info.st_mtimespec.tv_sec) * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+    return static_cast<long long>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+}
+
+/*! \brief Returns the size of a file in bytes or -1 if the file does not exist.
+ */
+inline long long GetFileSize(const std::string& path)
+{
+    struct stat info;
+
+    if (stat(path.c_str(), &info) != 0)
+    {
+        return -1;
+    }
+
+    return static_cast<long long>(info.st_size);
+}
+
 template <typename T> 
 std::string toString(const T& n)
 {
@@ -0,0 +1,101 @@
+#ifndef _DATASETCACHE_H_
+#define _DATASETCACHE_H_
+
+#include "Common.h"
+
+#include "SpeechData.h"
+
+#include <list>
+
+/*! \brief A cache of loaded and normalized speech data sets.
+ *
+ *  Data sets are identified by their normalized loading parameters and
+ *  the modification times of the loaded files. Returned data sets are shared
+ *  and must not be modified. When the memory budget is exceeded the least
+ *  recently used data sets that are not referenced outside the cache are evicted.
+ */
+class DatasetCache
+{
+public:
+    /*! \brief Constructor.
+     *
+     *  \param memoryBudget The memory budget in bytes.
+     */
+    explicit DatasetCache(std::size_t memoryBudget = 1024u * 1024u * 1024u);
+
+    virtual ~DatasetCache();
+
+    void SetMemoryBudget(std::size_t memoryBudget);
+
+    std::size_t GetMemoryBudget() const;
+
+    /*! \brief Returns the memory used by cached data sets in bytes.
+     */
+    std::size_t GetMemoryUsage() const;
+
+    /*! \brief Returns the number of cached data sets.
+     */
+    unsigned int GetSize() const;
+
+    /*! \brief Returns a data set, loading it with LoadTextSamples() if it is not cached.
+     *
+     *  \sa LoadTextSamples()
+     */
+    std::shared_ptr<SpeechData> Load(const std::string& folder, unsigned int sf, unsigned int gf, unsigned int sl, unsigned int gl, unsigned int multiplier, bool train);
+
+    /*! \brief Removes all data sets from the cache.
+     *
+     *  Data sets still referenced elsewhere stay valid.
+     */
+    void Clear();
+
+private:
+    struct Key
+    {
+        std::string path;
+        bool cmvn;
+        unsigned int cmvnWindow;
+        bool warp;
+        bool vad;
+        unsigned int warpWindow;
+        unsigned int maxFeatures;
+
+        unsigned int sf;
+        unsigned int gf;
+        unsigned int sl;
+        unsigned int gl;
+        unsigned int multiplier;
+        bool train;
+
+        std::vector<long long> modificationTimes;
+
+        bool operator< (const Key& rhs) const;
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<SpeechData> data;
+
+        std::size_t size;
+
+        std::list<Key>::iterator lruIt;
+    };
+
+private:
+    /*! \brief Evicts unused data sets until the memory budget is met.
+     */
+    void Evict();
+
+private:
+    std::size_t mMemoryBudget;
+
+    std::size_t mMemoryUsage;
+
+    std::map<Key, Entry> mEntries;
+
+    /*! \brief Cached keys, the most recently used first.
+     */
+    std::list<Key> mLru;
+};
+
+#endif
@@ -95,12 +95,24 @@ public:
      */
     void Assign(const DynamicVector& other);
 
+    /*! \brief Copies values from an array.
+     *
+     *  \param values At least GetSize() values.
+     */
+    void Assign(const T* values);
+
     /*! \brief Vector addition.
      *
      *  \param other The summand.
      */
     void Add(const DynamicVector& other);
 
+    /*! \brief Adds values from an array.
+     *
+     *  \param values At least GetSize() values.
+     */
+    void Add(const T* values);
+
     /*! \brief Vector subtraction.
      *
      *  \param other The subtrahend.
@@ -116,6 +128,17 @@ public:
      */
     T Distance(const DynamicVector& other) const;
 
+    /*! \brief Calculates a squared euclidean distance to an array of values.
+     *
+     *  \param values At least GetSize() values.
+     *  \return The squared euclidean distance.
+     */
+    T Distance(const T* values) const;
+
+    /*! \brief Returns the values as a contiguous array.
+     */
+    const T* GetData() const;
+
 private:
     std::vector<T> mValues;
 };
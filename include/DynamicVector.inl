@@ -70,6 +70,15 @@ void DynamicVector<T>::Assign(const DynamicVector& other)
     }
 }
 
+template<typename T>
+void DynamicVector<T>::Assign(const T* values)
+{
+    for (unsigned int i = 0; i < mValues.size(); i++)
+    {
+        mValues[i] = values[i];
+    }
+}
+
 template<typename T>
 void DynamicVector<T>::Multiply(T value)
 {
@@ -115,6 +124,15 @@ void DynamicVector<T>::Add(const DynamicVector& other)
     }
 }
 
+template<typename T>
+void DynamicVector<T>::Add(const T* values)
+{
+    for (unsigned int i = 0; i < mValues.size(); i++)
+    {
+        mValues[i] += values[i];
+    }
+}
+
 template<typename T>
 void DynamicVector<T>::Subtract(const DynamicVector& other)
 {
@@ -138,3 +156,24 @@ T DynamicVector<T>::Distance(const DynamicVector& other) const
 
     return distance;
 }
+
+template<typename T>
+T DynamicVector<T>::Distance(const T* values) const
+{
+    T distance = T();
+
+    for (unsigned int i = 0; i < mValues.size(); i++)
+    {
+        T diff = mValues[i] - values[i];
+
+        distance += diff * diff;
+    }
+
+    return distance;
+}
+
+template<typename T>
+const T* DynamicVector<T>::GetData() const
+{
+    return mValues.data();
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#ifndef _FEATUREFILE_H_
+#define _FEATUREFILE_H_
+
+#include "Common.h"
+
+#include <cstdint>
+
+/*! \brief A memory-mapped binary container for speech features.
+ *
+ *  The layout of the file (native byte order) is:
+ *  - Header: magic, version, dimension count and section offsets.
+ *  - Utterance index: one entry per line of the source text file.
+ *  - Frames: contiguous rows of 32-bit floats, GetDimensionCount() values per row.
+ *
+ *  Utterances are exposed as pointers into the mapped file, so no data is
+ *  copied or parsed when the file is opened.
+ *
+ *  \sa ConvertTextSamples()
+ */
+class FeatureFile
+{
+public:
+    /*! \brief Current version of the binary layout.
+     */
+    static const std::uint32_t VERSION = 1;
+
+    /*! \brief Maximum label length including the terminating zero.
+     */
+    static const unsigned int LABEL_SIZE = 32;
+
+    struct Header
+    {
+        char magic[4]; /*!< Always "SRFF". */
+        std::uint32_t version; /*!< Layout version, see VERSION. */
+        std::uint32_t dimensionCount; /*!< Number of values per frame. */
+        std::uint32_t utteranceCount; /*!< Number of index entries (source lines). */
+        std::uint64_t frameCount; /*!< Total number of frames in the file. */
+        std::uint64_t indexOffset; /*!< Byte offset of the utterance index. */
+        std::uint64_t dataOffset; /*!< Byte offset of the frame data (64-byte aligned). */
+    };
+
+    struct UtteranceEntry
+    {
+        char label[LABEL_SIZE]; /*!< Zero-terminated label, empty for lines without data. */
+        std::uint64_t firstFrame; /*!< Index of the first frame of this utterance. */
+        std::uint32_t frameCount; /*!< Number of frames in this utterance. */
+        std::uint32_t reserved;
+    };
+
+public:
+    FeatureFile();
+
+    virtual ~FeatureFile();
+
+    /*! \brief Maps a binary feature file into memory.
+     *
+     *  \return False if the file could not be mapped or is not a valid feature file.
+     */
+    bool Open(const std::string& path);
+
+    /*! \brief Unmaps the file.
+     */
+    void Close();
+
+    bool IsOpen() const;
+
+    unsigned int GetDimensionCount() const;
+
+    /*! \brief Returns the number of utterances (source lines) in the file.
+     */
+    unsigned int GetUtteranceCount() const;
+
+    /*! \brief Returns the label of an utterance.
+     *
+     *  \param utterance Zero-based utterance index.
+     */
+    std::string GetLabel(unsigned int utterance) const;
+
+    /*! \brief Returns the number of frames in an utterance.
+     */
+    unsigned int GetFrameCount(unsigned int utterance) const;
+
+    /*! \brief Returns the frames of an utterance as contiguous rows.
+     *
+     *  The pointer stays valid until the file is closed.
+     */
+    const float* GetFrames(unsigned int utterance) const;
+
+    /*! \brief Writes a binary feature file.
+     *
+     *  \param labels A label for each utterance.
+     *  \param frameCounts The number of frames of each utterance.
+     *  \param frames All frames of all utterances as contiguous rows.
+     */
+    static bool Write(
+        const std::string& path,
+        unsigned int dimensionCount,
+        const std::vector<std::string>& labels,
+        const std::vector<unsigned int>& frameCounts,
+        const std::vector<float>& frames);
+
+private:
+    const UtteranceEntry& GetEntry(unsigned int utterance) const;
+
+private:
+    const char* mData;
+
+    std::size_t mSize;
+
+    const Header* mHeader;
+
+#ifdef _WIN32
+    void* mFileHandle;
+
+    void* mMappingHandle;
+#endif
+};
+
+/*! \brief Returns the path of the binary feature file that corresponds to a text file.
+ *
+ *  The extension is replaced by ".bin", i.e. samples_1.txt -> samples_1.bin.
+ */
+std::string GetBinarySamplesPath(const std::string& textPath);
+
+/*! \brief Converts a text feature file to the binary format.
+ *
+ *  All frames must have the same number of features.
+ */
+bool ConvertTextSamples(const std::string& textPath, const std::string& binaryPath);
+
+#endif
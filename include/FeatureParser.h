@@ -0,0 +1,68 @@
+#ifndef _FEATUREPARSER_H_
+#define _FEATUREPARSER_H_
+
+#include "Common.h"
+
+/*! \brief Parses a line of a text sample file in place.
+ *
+ *  Line format: [label] [frame 1],[frame 2],... where the values of a frame
+ *  are separated by spaces. Values are converted with std::from_chars and
+ *  no memory is allocated per value.
+ */
+class FeatureParser
+{
+public:
+    /*! \brief Constructor.
+     *
+     *  \note The characters must stay valid while the parser is used.
+     */
+    FeatureParser(const char* begin, const char* end);
+
+    explicit FeatureParser(const std::string& line);
+
+    /*! \brief Reads the label at the beginning of the line.
+     *
+     *  \return False if the line contains only whitespace.
+     */
+    bool ReadLabel(std::string& label);
+
+    /*! \brief Reads the values of the next frame.
+     *
+     *  A value is parsed as type Parsed and then stored as type T, so that
+     *  Parsed = float gives the same values as std::stof(). Values after the
+     *  first maxValues values of a frame are skipped. Values that cannot be
+     *  parsed are skipped and make HasError() return true.
+     *
+     *  \param values Cleared and filled with the values of the frame. May be empty.
+     *  \return False if there are no more frames on the line.
+     */
+    template<typename Parsed, typename T>
+    bool ReadFrame(std::vector<T>& values, unsigned int maxValues = std::numeric_limits<unsigned int>::max());
+
+    /*! \brief Checks if some value could not be parsed.
+     */
+    bool HasError() const;
+
+    /*! \brief Parses a single value like std::strtof() and std::strtod().
+     *
+     *  Leading whitespace and a leading plus sign are accepted, trailing characters are ignored.
+     *
+     *  \return False if the characters do not start with a value or the value is out of range.
+     */
+    template<typename T>
+    static bool ParseValue(const char* begin, const char* end, T& value);
+
+private:
+    static bool IsSpace(char c);
+
+private:
+    const char* mPosition;
+
+    const char* mEnd;
+
+    bool mError;
+};
+
+#include "FeatureParser.inl"
+
+#endif
@@ -0,0 +1,126 @@
+#include <charconv>
+#include <cstring>
+
+inline FeatureParser::FeatureParser(const char* begin, const char* end)
+    : mPosition(begin),
+    mEnd(end),
+    mError(false)
+{
+
+}
+
+inline FeatureParser::FeatureParser(const std::string& line)
+    : FeatureParser(line.data(), line.data() + line.size())
+{
+
+}
+
+inline bool FeatureParser::ReadLabel(std::string& label)
+{
+    while (mPosition != mEnd && IsSpace(*mPosition))
+    {
+        ++mPosition;
+    }
+
+    const char* begin = mPosition;
+
+    while (mPosition != mEnd && !IsSpace(*mPosition))
+    {
+        ++mPosition;
+    }
+
+    if (begin == mPosition)
+    {
+        return false;
+    }
+
+    label.assign(begin, mPosition);
+
+    return true;
+}
+
+template<typename Parsed, typename T>
+bool FeatureParser::ReadFrame(std::vector<T>& values, unsigned int maxValues)
+{
+    values.clear();
+
+    if (mPosition == mEnd)
+    {
+        return false;
+    }
+
+    // Frames are separated by commas.
+    const char* frameEnd = static_cast<const char*>(std::memchr(mPosition, ',', mEnd - mPosition));
+
+    if (!frameEnd)
+    {
+        frameEnd = mEnd;
+    }
+
+    unsigned int valueCount = 0;
+
+    // Values are separated by spaces.
+    while (mPosition != frameEnd && valueCount < maxValues)
+    {
+        if (*mPosition == ' ')
+        {
+            ++mPosition;
+            continue;
+        }
+
+        const char* valueEnd = mPosition;
+
+        while (valueEnd != frameEnd && *valueEnd != ' ')
+        {
+            ++valueEnd;
+        }
+
+        Parsed value;
+
+        if (ParseValue(mPosition, valueEnd, value))
+        {
+            values.push_back(static_cast<T>(value));
+        }
+
+        else
+        {
+            mError = true;
+        }
+
+        ++valueCount;
+        mPosition = valueEnd;
+    }
+
+    mPosition = (frameEnd == mEnd) ? mEnd : frameEnd + 1;
+
+    return true;
+}
+
+inline bool FeatureParser::HasError() const
+{
+    return mError;
+}
+
+template<typename T>
+bool FeatureParser::ParseValue(const char* begin, const char* end, T& value)
+{
+    while (begin != end && IsSpace(*begin))
+    {
+        ++begin;
+    }
+
+    // std::from_chars() does not accept a plus sign.
+    if (begin != end && *begin == '+' && (begin + 1 == end || *(begin + 1) != '-'))
+    {
+        ++begin;
+    }
+
+    auto result = std::from_chars(begin, end, value);
+
+    return result.ec == std::errc();
+}
+
+inline bool FeatureParser::IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
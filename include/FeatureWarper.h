@@ -0,0 +1,65 @@
+#ifndef _FEATUREWARPER_H_
+#define _FEATUREWARPER_H_
+
+#include "Common.h"
+
+#include "FrameMatrix.h"
+
+/*! \brief Feature warping (short-time gaussianization).
+ *
+ *  Each value is replaced by the standard normal quantile of its rank among
+ *  the values of the same dimension in a window of frames centered on it.
+ *  The ranks are tracked with a Fenwick tree over the sorted values of the
+ *  warped range, so moving the window costs O(log n) per frame and dimension.
+ */
+class FeatureWarper
+{
+public:
+    /*! \brief Constructor.
+     *
+     *  \param windowSize The number of frames in the window.
+     */
+    explicit FeatureWarper(unsigned int windowSize = 300);
+
+    virtual ~FeatureWarper();
+
+    void SetWindowSize(unsigned int windowSize);
+
+    unsigned int GetWindowSize() const;
+
+    /*! \brief Warps the frames [begin, end) in place.
+     *
+     *  Windows are truncated at the ends of the range.
+     */
+    void Warp(FrameMatrix& frames, unsigned int begin, unsigned int end);
+
+private:
+    /*! \brief Warps one dimension of the frames [begin, end).
+     */
+    void Warp(FrameMatrix& frames, unsigned int begin, unsigned int end, unsigned int dimension);
+
+    /*! \brief Adds count to the number of values with a sorted index.
+     */
+    void Update(unsigned int index, int count);
+
+    /*! \brief Returns the number of values in the window with sorted indices [0, index).
+     */
+    unsigned int GetCount(unsigned int index) const;
+
+private:
+    unsigned int mWindowSize;
+
+    /*! \brief Sorted distinct values of the warped dimension.
+     */
+    std::vector<Real> mSortedValues;
+
+    /*! \brief Index of each frame's value in mSortedValues.
+     */
+    std::vector<unsigned int> mIndices;
+
+    /*! \brief Fenwick tree of value counts in the window, indexed from 1.
+     */
+    std::vector<unsigned int> mTree;
+};
+
+#endif
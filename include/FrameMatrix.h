@@ -0,0 +1,218 @@
+#ifndef _FRAMEMATRIX_H_
+#define _FRAMEMATRIX_H_
+
+#include "Common.h"
+
+#include <new>
+
+/*! \brief A standard allocator that aligns allocations to a given boundary.
+ *
+ *  \tparam T Value type.
+ *  \tparam Alignment Alignment in bytes.
+ */
+template<typename T, std::size_t Alignment>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() { }
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) { }
+
+    T* allocate(std::size_t count)
+    {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* values, std::size_t)
+    {
+        ::operator delete(values, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator== (const AlignedAllocator<U, Alignment>&) const { return true; }
+
+    template<typename U>
+    bool operator!= (const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+class FrameMatrix;
+
+/*! \brief A non-owning view to row-major feature frames.
+ *
+ *  Frames are stored one after another, each frame taking GetStride() values
+ *  of which the first GetDimensionCount() values are features. The view is
+ *  cheap to copy and valid as long as the viewed storage is not modified.
+ */
+class FrameView
+{
+public:
+    FrameView();
+
+    FrameView(const Real* data, unsigned int frameCount, unsigned int dimensionCount, unsigned int stride);
+
+    /*! \brief Views all frames of a matrix.
+     */
+    FrameView(const FrameMatrix& matrix);
+
+    unsigned int GetFrameCount() const;
+
+    unsigned int GetDimensionCount() const;
+
+    /*! \brief Returns the distance between two consecutive frames in values.
+     */
+    unsigned int GetStride() const;
+
+    bool IsEmpty() const;
+
+    const Real* GetData() const;
+
+    /*! \brief Returns the feature values of a frame.
+     */
+    const Real* operator[] (unsigned int frame) const;
+
+    /*! \brief Returns a view to the frames [begin, end).
+     */
+    FrameView GetFrames(unsigned int begin, unsigned int end) const;
+
+private:
+    const Real* mData;
+
+    unsigned int mFrameCount;
+
+    unsigned int mDimensionCount;
+
+    unsigned int mStride;
+};
+
+/*! \brief Row-major storage of feature frames in a single aligned buffer.
+ *
+ *  Each frame is padded to a multiple of FrameMatrix::PADDING values with zeros so that
+ *  every frame starts at an aligned address. The matrix also keeps the frame
+ *  offsets of the utterances the frames were loaded from.
+ */
+class FrameMatrix
+{
+public:
+    /*! \brief Alignment of the buffer in bytes.
+     */
+    static const unsigned int ALIGNMENT = 64;
+
+    /*! \brief Frame strides are rounded up to a multiple of this many values.
+     */
+    static const unsigned int PADDING = 32 / sizeof(Real);
+
+public:
+    /*! \brief Constructor.
+     *
+     *  \param dimensionCount The number of features in each frame.
+     */
+    explicit FrameMatrix(unsigned int dimensionCount = 0);
+
+    /*! \brief Sets the dimension count.
+     *
+     *  \note Removes all frames.
+     */
+    void SetDimensionCount(unsigned int dimensionCount);
+
+    unsigned int GetDimensionCount() const;
+
+    unsigned int GetStride() const;
+
+    unsigned int GetFrameCount() const;
+
+    /*! \brief Reserves storage for a given number of frames.
+     */
+    void Reserve(unsigned int frameCount);
+
+    /*! \brief Marks that the next added frame starts a new utterance.
+     */
+    void BeginUtterance();
+
+    /*! \brief Adds a zero-initialized frame.
+     *
+     *  \return The feature values of the new frame.
+     */
+    Real* AddFrame();
+
+    /*! \brief Adds a frame and copies its values.
+     *
+     *  \param values GetDimensionCount() feature values.
+     */
+    void AddFrame(const Real* values);
+
+    /*! \brief Appends frames from a view as a single utterance.
+     *
+     *  \note Dimension counts must match.
+     */
+    void Append(const FrameView& frames);
+
+    /*! \brief Appends all frames and utterances of another matrix.
+     *
+     *  \note Dimension counts must match.
+     */
+    void Append(const FrameMatrix& other);
+
+    /*! \brief Returns the number of utterances.
+     */
+    unsigned int GetUtteranceCount() const;
+
+    /*! \brief Returns the index of the first frame of an utterance.
+     */
+    unsigned int GetUtteranceBegin(unsigned int utterance) const;
+
+    /*! \brief Returns the index after the last frame of an utterance.
+     */
+    unsigned int GetUtteranceEnd(unsigned int utterance) const;
+
+    /*! \brief Returns a view to the frames of an utterance.
+     */
+    FrameView GetUtterance(unsigned int utterance) const;
+
+    /*! \brief Returns a view to the frames [begin, end).
+     */
+    FrameView GetFrames(unsigned int begin, unsigned int end) const;
+
+    Real* operator[] (unsigned int frame);
+
+    const Real* operator[] (unsigned int frame) const;
+
+    Real* GetData();
+
+    const Real* GetData() const;
+
+    /*! \brief Removes all frames and utterances.
+     *
+     *  The dimension count is preserved.
+     */
+    void Clear();
+
+    /*! \brief Returns the number of bytes allocated for frames and utterances.
+     */
+    std::size_t GetMemoryUsage() const;
+
+private:
+    unsigned int mDimensionCount;
+
+    unsigned int mStride;
+
+    unsigned int mFrameCount;
+
+    bool mNewUtterance;
+
+    std::vector<Real, AlignedAllocator<Real, ALIGNMENT> > mValues;
+
+    std::vector<unsigned int> mUtteranceOffsets;
+};
+
+#include "FrameMatrix.inl"
+
+#endif
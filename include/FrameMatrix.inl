@@ -0,0 +1,202 @@
+inline FrameView::FrameView()
+    : mData(nullptr),
+    mFrameCount(0),
+    mDimensionCount(0),
+    mStride(0)
+{
+
+}
+
+inline FrameView::FrameView(const Real* data, unsigned int frameCount, unsigned int dimensionCount, unsigned int stride)
+    : mData(data),
+    mFrameCount(frameCount),
+    mDimensionCount(dimensionCount),
+    mStride(stride)
+{
+
+}
+
+inline FrameView::FrameView(const FrameMatrix& matrix)
+    : mData(matrix.GetData()),
+    mFrameCount(matrix.GetFrameCount()),
+    mDimensionCount(matrix.GetDimensionCount()),
+    mStride(matrix.GetStride())
+{
+
+}
+
+inline unsigned int FrameView::GetFrameCount() const
+{
+    return mFrameCount;
+}
+
+inline unsigned int FrameView::GetDimensionCount() const
+{
+    return mDimensionCount;
+}
+
+inline unsigned int FrameView::GetStride() const
+{
+    return mStride;
+}
+
+inline bool FrameView::IsEmpty() const
+{
+    return mFrameCount == 0;
+}
+
+inline const Real* FrameView::GetData() const
+{
+    return mData;
+}
+
+inline const Real* FrameView::operator[] (unsigned int frame) const
+{
+    return mData + static_cast<std::size_t>(frame) * mStride;
+}
+
+inline FrameView FrameView::GetFrames(unsigned int begin, unsigned int end) const
+{
+    return FrameView((*this)[begin], end - begin, mDimensionCount, mStride);
+}
+
+inline FrameMatrix::FrameMatrix(unsigned int dimensionCount)
+    : mDimensionCount(0),
+    mStride(0),
+    mFrameCount(0),
+    mNewUtterance(true)
+{
+    SetDimensionCount(dimensionCount);
+}
+
+inline void FrameMatrix::SetDimensionCount(unsigned int dimensionCount)
+{
+    Clear();
+
+    mDimensionCount = dimensionCount;
+    mStride = (dimensionCount + PADDING - 1) / PADDING * PADDING;
+}
+
+inline unsigned int FrameMatrix::GetDimensionCount() const
+{
+    return mDimensionCount;
+}
+
+inline unsigned int FrameMatrix::GetStride() const
+{
+    return mStride;
+}
+
+inline unsigned int FrameMatrix::GetFrameCount() const
+{
+    return mFrameCount;
+}
+
+inline void FrameMatrix::Reserve(unsigned int frameCount)
+{
+    mValues.reserve(static_cast<std::size_t>(frameCount) * mStride);
+}
+
+inline void FrameMatrix::BeginUtterance()
+{
+    mNewUtterance = true;
+}
+
+inline Real* FrameMatrix::AddFrame()
+{
+    if (mNewUtterance)
+    {
+        mUtteranceOffsets.push_back(mFrameCount);
+        mNewUtterance = false;
+    }
+
+    mValues.resize(mValues.size() + mStride, Real());
+
+    return (*this)[mFrameCount++];
+}
+
+inline void FrameMatrix::AddFrame(const Real* values)
+{
+    std::copy(values, values + mDimensionCount, AddFrame());
+}
+
+inline void FrameMatrix::Append(const FrameView& frames)
+{
+    BeginUtterance();
+
+    for (unsigned int f = 0; f < frames.GetFrameCount(); ++f)
+    {
+        AddFrame(frames[f]);
+    }
+}
+
+inline void FrameMatrix::Append(const FrameMatrix& other)
+{
+    for (unsigned int u = 0; u < other.GetUtteranceCount(); ++u)
+    {
+        Append(other.GetUtterance(u));
+    }
+}
+
+inline unsigned int FrameMatrix::GetUtteranceCount() const
+{
+    return mUtteranceOffsets.size();
+}
+
+inline unsigned int FrameMatrix::GetUtteranceBegin(unsigned int utterance) const
+{
+    return mUtteranceOffsets[utterance];
+}
+
+inline unsigned int FrameMatrix::GetUtteranceEnd(unsigned int utterance) const
+{
+    if (utterance + 1 < mUtteranceOffsets.size())
+    {
+        return mUtteranceOffsets[utterance + 1];
+    }
+
+    return mFrameCount;
+}
+
+inline FrameView FrameMatrix::GetUtterance(unsigned int utterance) const
+{
+    return GetFrames(GetUtteranceBegin(utterance), GetUtteranceEnd(utterance));
+}
+
+inline FrameView FrameMatrix::GetFrames(unsigned int begin, unsigned int end) const
+{
+    return FrameView((*this)[begin], end - begin, mDimensionCount, mStride);
+}
+
+inline Real* FrameMatrix::operator[] (unsigned int frame)
+{
+    return mValues.data() + static_cast<std::size_t>(frame) * mStride;
+}
+
+inline const Real* FrameMatrix::operator[] (unsigned int frame) const
+{
+    return mValues.data() + static_cast<std::size_t>(frame) * mStride;
+}
+
+inline Real* FrameMatrix::GetData()
+{
+    return mValues.data();
+}
+
+inline const Real* FrameMatrix::GetData() const
+{
+    return mValues.data();
+}
+
+inline void FrameMatrix::Clear()
+{
+    mValues.clear();
+    mUtteranceOffsets.clear();
+    mFrameCount = 0;
+    mNewUtterance = true;
+}
+
+inline std::size_t FrameMatrix::GetMemoryUsage() const
+{
+    return mValues.capacity() * sizeof(Real) + mUtteranceOffsets.capacity() * sizeof(unsigned int);
+}
@@ -0,0 +1,133 @@
+#ifndef _FULLGMMODEL_H_
+#define _FULLGMMODEL_H_
+
+#include "Common.h"
+
+#include "Model.h"
+
+/*! \brief A Gaussian Mixture Model with full covariance matrices.
+ *
+ *  Each covariance is stored as its lower Cholesky factor L, so that
+ *
+ *  log(w_c * N(x | c)) = K_c - 0.5 * |z|^2,  L_c * z = x - mu_c
+ *
+ *  where K_c holds the weight, the log-determinant 2 * sum(log(L_ii)) and
+ *  the pdf constant. Frames are transposed into blocks of BLOCK_FRAMES so that
+ *  the forward substitution of one component runs over all frames of a block
+ *  at once. A full covariance costs O(D^2) per frame and component instead of
+ *  O(D), which is offset by needing fewer components.
+ */
+class FullGMModel : public Model
+{
+public:
+    /*! \brief The number of frames in a block of the triangular solves.
+     */
+    static const unsigned int BLOCK_FRAMES = 64;
+
+    struct Component
+    {
+        std::vector<Real> means; /*!< The means of each dimension. */
+        std::vector<Real> cholesky; /*!< The lower Cholesky factor of the covariance, row-major D x D. */
+        std::vector<Real> choleskyDiagonalInv; /*!< 1 / L_ii. */
+        Real mixingCoefficient; /*!< The mixing factor / weight of this component. */
+        Real logDeterminant; /*!< The log-determinant of the covariance. */
+        Real constant; /*!< log(w) - 0.5 * (D * log(2 * pi) + log-determinant). */
+    };
+
+private:
+    /*! \brief Sufficient statistics accumulated by the E-step over a range of frames.
+     */
+    struct Statistics
+    {
+        std::vector<Real> probabilitySums; /*!< sum(P(k|x_n)) of each component. */
+        std::vector<Real> meanSums; /*!< sum(P(k|x_n) * x_n) of each component. */
+        std::vector<Real> productSums; /*!< sum(P(k|x_n) * x_n * x_n^T) of each component, lower triangle of a row-major D x D matrix. */
+        Real logLikelihood;
+    };
+
+public:
+    FullGMModel();
+
+    virtual ~FullGMModel();
+
+    void SetTrainingThreshold(Real threshold);
+
+    Real GetTrainingThreshold() const;
+
+    const std::vector<Component>& GetComponents() const;
+
+    /*! \brief Trains the model with LBG initialization and EM.
+     */
+    virtual void Train(const FrameView& samples, unsigned int iterations) override;
+
+    /*! \brief Maximum a Posteriori adaptation of the means.
+     *
+     *  The covariances and weights are copied from the other model.
+     */
+    virtual void Adapt(const std::shared_ptr<Model>& other, const FrameView& samples,
+                       unsigned int iterations = 2, Real relevanceFactor = 16.0f) override;
+
+    /*! \brief Calculates the normalized log-likelihood value over given samples.
+     *
+     *  \sa GMModel::GetLogLikelihood()
+     */
+    Real GetLogLikelihood(const FrameView& samples, ScoringWorkspace& workspace) const;
+
+    using Model::GetScore;
+    using Model::GetLogScore;
+
+    virtual Real GetScore(const FrameView& samples, ScoringWorkspace& workspace) const override;
+
+    virtual Real GetLogScore(const FrameView& samples, ScoringWorkspace& workspace) const override;
+
+    virtual unsigned int GetDimensionCount() const override;
+
+private:
+    /*! \brief Computes the weighted log-likelihoods of the frames [begin, end).
+     *
+     *  \param begin The first frame, end - begin is at most BLOCK_FRAMES.
+     *  \param block Scratch memory of 2 * D * BLOCK_FRAMES values, filled with
+     *               the transposed frames in the first D * BLOCK_FRAMES values.
+     *  \param output (end - begin) * component count values, one row for each frame.
+     */
+    void GetLogLikelihoods(const FrameView& samples, unsigned int begin, unsigned int end, Real* block, Real* output) const;
+
+    void InitComponents(const FrameView& samples);
+
+    /*! \brief The E-step, accumulated in parallel over contiguous frame ranges.
+     *
+     *  \param products False to skip the second order statistics, which MAP adaptation does not need.
+     *  \return Log-likelihood over samples.
+     */
+    Real E(const FrameView& samples, bool products, Statistics& statistics) const;
+
+    void AccumulateStatistics(const FrameView& samples, unsigned int begin, unsigned int end,
+                              bool products, Statistics& statistics) const;
+
+    /*! \brief The M-step of the EM-algorithm.
+     */
+    void M(const Statistics& statistics, Real frameCount);
+
+    /*! \brief Factorizes a covariance and updates the constants of a component.
+     *
+     *  The diagonal is increased until the covariance is positive definite.
+     *
+     *  \param covariance A symmetric row-major D x D matrix, only the lower triangle is used.
+     */
+    void SetCovariance(Component& component, const std::vector<Real>& covariance);
+
+    /*! \brief Updates the constant of a component after a weight change.
+     */
+    void UpdateConstant(Component& component);
+
+private:
+    unsigned int mDimensionCount;
+
+    unsigned int mTrainingIterations;
+
+    Real mEta;
+
+    std::vector<Component> mComponents;
+};
+
+#endif
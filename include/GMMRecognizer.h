@@ -4,6 +4,17 @@
 #include "SpeechData.h"
 #include "RecognitionResult.h"
 #include "ModelRecognizer.h"
+#include "MixtureKernel.h"
+#include "BaumWelchStatistics.h"
+#include "GMModelBank.h"
+
+#include <mutex>
+
+enum class CovarianceType
+{
+    DIAGONAL, //!< GMModel.
+    FULL      //!< FullGMModel.
+};
 
 class GMMRecognizer : public ModelRecognizer
 {
@@ -16,8 +27,232 @@ public:
 
     virtual void Test(const std::shared_ptr<SpeechData>& data, std::map<SpeakerKey, RecognitionResult>& results) override;
 
+    /*! \brief Clears the trained models, the model bank and the cached adaptation statistics.
+     */
+    virtual void ClearTrainedData() override;
+
+    /*! \brief Sets the covariance type of the models.
+     *
+     *  Full covariances cost O(D^2) per component instead of O(D), so they are
+     *  usually combined with a lower order. Changing the type clears the
+     *  trained models.
+     *
+     *  \note Top components, exp accuracy, posterior thresholds, mini-batch
+     *        training and order reduction only apply to diagonal models.
+     */
+    void SetCovarianceType(CovarianceType type);
+
+    CovarianceType GetCovarianceType() const;
+
+    /*! \brief Sets the number of background model components used to score adapted speaker models.
+     *
+     *  The background model is evaluated fully for each frame and only its
+     *  best components are evaluated in the speaker models. This is only
+     *  applied to speaker models adapted from the background model.
+     *  Changing the count recomputes the score normalization.
+     *
+     *  \param count The number of components, 0 to evaluate all components.
+     */
+    void SetTopComponentCount(unsigned int count);
+
+    unsigned int GetTopComponentCount() const;
+
+    /*! \brief Sets the number of background model components evaluated for the adaptation statistics.
+     *
+     *  Changing the count clears the trained models.
+     *
+     *  \param count The number of components, 0 to evaluate all components.
+     *  \sa AdaptModel()
+     */
+    void SetAdaptationTopComponentCount(unsigned int count);
+
+    unsigned int GetAdaptationTopComponentCount() const;
+
+    /*! \brief Sets the accuracy of exp in model training and scoring.
+     *
+     *  Changing the accuracy clears the trained models.
+     *
+     *  \sa GMModel::SetExpAccuracy()
+     */
+    void SetExpAccuracy(ExpAccuracy accuracy);
+
+    ExpAccuracy GetExpAccuracy() const;
+
+    /*! \brief Sets the tolerance of the checked exp mode.
+     *
+     *  Changing the tolerance clears the trained models.
+     *
+     *  \sa GMModel::SetExpTolerance()
+     */
+    void SetExpTolerance(Real tolerance);
+
+    Real GetExpTolerance() const;
+
+    /*! \brief Sets the minimum posterior of a cluster accumulated by model training.
+     *
+     *  Changing the threshold clears the trained models.
+     *
+     *  \sa GMModel::SetPosteriorThreshold()
+     */
+    void SetPosteriorThreshold(Real threshold);
+
+    Real GetPosteriorThreshold() const;
+
+    /*! \brief Sets the mini-batch size of background model training.
+     *
+     *  Changing the size clears the trained models.
+     *
+     *  \param batchSize The number of frames, 0 for EM over all frames.
+     *  \sa GMModel::SetBatchSize()
+     */
+    void SetBatchSize(unsigned int batchSize);
+
+    unsigned int GetBatchSize() const;
+
+    /*! \brief Sets the number of mini-batches in each iteration of background model training.
+     *
+     *  Changing the count clears the trained models.
+     *
+     *  \sa GMModel::SetBatchCount()
+     */
+    void SetBatchCount(unsigned int batchCount);
+
+    unsigned int GetBatchCount() const;
+
+    /*! \brief Sets the step size exponent of background model training.
+     *
+     *  Changing the exponent clears the trained models.
+     *
+     *  \sa GMModel::SetStepExponent()
+     */
+    void SetStepExponent(Real exponent);
+
+    Real GetStepExponent() const;
+
+    /*! \brief Sets the order the background model is reduced to after training.
+     *
+     *  The background model is trained with GetOrder() clusters and reduced
+     *  with GMModel::Reduce() before the speaker models are adapted from it,
+     *  so the speaker models are cheaper to adapt and score. Changing the
+     *  order clears the trained models.
+     *
+     *  \param order The number of clusters, 0 to disable the reduction.
+     */
+    void SetReducedOrder(unsigned int order);
+
+    unsigned int GetReducedOrder() const;
+
+    /*! \brief Sets the merge cost budget of the background model reduction.
+     *
+     *  Changing the budget clears the trained models.
+     *
+     *  \sa GMModel::Reduce()
+     */
+    void SetReductionLossBudget(Real lossBudget);
+
+    Real GetReductionLossBudget() const;
+
 protected:
     virtual std::shared_ptr<Model> CreateModel();
+
+    /*! \brief Creates a model trained with stepwise EM if a batch size is set.
+     */
+    virtual std::shared_ptr<Model> CreateBackgroundModel() override;
+
+    /*! \brief Trains the background model and reduces its order if enabled.
+     */
+    virtual void TrainBackgroundModel() override;
+
+    /*! \brief Adapts a speaker model with cached Baum-Welch statistics.
+     *
+     *  With one adaptation iteration MAP adaptation is a closed-form update of
+     *  the statistics of the speaker against the background model. The
+     *  statistics are computed once for each speaker and background model, so
+     *  changing the relevance factor does not evaluate the frames again.
+     *  Otherwise Model::Adapt() is used.
+     */
+    virtual void AdaptModel(const std::shared_ptr<Model>& model, const SpeakerKey& speaker, const FrameView& samples) override;
+
+    /*! \brief Adapts the models of a relevance factor sweep from the same cached statistics.
+     *
+     *  The frames of the speaker are aligned to the background model once
+     *  for all factors. With more than one adaptation iteration the
+     *  alignments depend on the factor and each model is adapted separately.
+     */
+    virtual void AdaptModels(const std::vector<std::shared_ptr<Model> >& models, const SpeakerKey& speaker,
+                             const FrameView& samples, const std::vector<Real>& factors) override;
+
+    /*! \brief Builds the model bank of the speaker models if they share variances and weights.
+     */
+    virtual void PrepareModels() override;
+
+    /*! \brief Drops the model bank, the speaker models may have changed.
+     */
+    virtual void Unprepare() override;
+
+    /*! \brief Calculates the speaker/background log-likelihood ratio with top-C scoring if enabled.
+     */
+    virtual Real GetRatio(const std::shared_ptr<Model>& model, const FrameView& samples) override;
+
+    /*! \brief Calculates the ratios of several models.
+     *
+     *  The background model is evaluated once. Models sharing variances and
+     *  weights are scored together with a GMModelBank, or with the top
+     *  components of the background model if enabled.
+     */
+    virtual std::vector<Real> GetRatios(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples) override;
+
+    virtual std::vector<Real> GetScores(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples) override;
+
+    /*! \brief Scores speaker models with the model bank built by PrepareModels().
+     *
+     *  Other models are scored separately.
+     */
+    virtual std::vector<Real> GetLogScores(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples) override;
+
+private:
+    /*! \brief Returns true if a model can be scored with the top components of the background model.
+     */
+    bool IsTopComponentScoringEnabled(const std::shared_ptr<Model>& model);
+
+private:
+    CovarianceType mCovarianceType;
+
+    unsigned int mTopComponentCount;
+
+    unsigned int mAdaptationTopComponentCount;
+
+    ExpAccuracy mExpAccuracy;
+
+    Real mExpTolerance;
+
+    Real mPosteriorThreshold;
+
+    unsigned int mBatchSize;
+
+    unsigned int mBatchCount;
+
+    Real mStepExponent;
+
+    unsigned int mReducedOrder;
+
+    Real mReductionLossBudget;
+
+    /*! \brief The background model the cached statistics were accumulated against.
+     */
+    std::shared_ptr<Model> mStatisticsBackgroundModel;
+
+    std::map<SpeakerKey, BaumWelchStatistics> mStatistics;
+
+    std::mutex mStatisticsMutex;
+
+    /*! \brief The speaker models scored together, empty if they do not share their structure.
+     */
+    GMModelBank mModelBank;
+
+    /*! \brief The index of each speaker model in mModelBank.
+     */
+    std::map<const Model*, unsigned int> mModelBankIndices;
 };
 
 #endif
@@ -5,12 +5,23 @@
 
 #include "DynamicVector.h"
 
+#include "BaumWelchStatistics.h"
+#include "MixtureKernel.h"
 #include "Model.h"
 
 /*! \brief A Gaussian Mixture Model using EM-algorithm & MAP-adaptation.
  */
 class GMModel : public Model
 {
+public:
+    /*! \brief The default number of mini-batches in each iteration of stepwise EM.
+     */
+    static const unsigned int DEFAULT_BATCH_COUNT = 16;
+
+    /*! \brief The maximum number of mini-batches of frames the clusters of stepwise EM are initialized from.
+     */
+    static const unsigned int INITIAL_BATCH_COUNT = 16;
+
 public:
     struct Cluster
     {
@@ -18,19 +29,25 @@ public:
         DynamicVector<Real> variances; /*!< The variances of each dimension. */
         Real mixingCoefficient; /*!< The mixing factor / weight of this cluster. */
 
-        // Utility variables do not touch these.
-
-        DynamicVector<Real> meansTmp;
+        // Derived from the parameters by UpdatePDF(), scoring uses the kernel.
 
-        DynamicVector<Real> variancesTmp;
         DynamicVector<Real> variancesInv;
 
-        Real membershipProbability; /*!< P(k|x_n;phi) */
-        Real membershipProbabilitySum; /*!< sum(P(k|x_n;phi)) */
-
         Real pdfConstant; /*!< A precalculated constant for faster pdf calculations. */
     };
 
+private:
+    /*! \brief Sufficient statistics accumulated by the E-step over frames.
+     */
+    struct Statistics
+    {
+        std::vector<Real> probabilitySums; /*!< sum(P(k|x_n;phi)) of each cluster. */
+        std::vector<Real> meanSums; /*!< sum(P(k|x_n;phi) * x_n) of each cluster and dimension. */
+        std::vector<Real> squareSums; /*!< sum(P(k|x_n;phi) * x_n^2) of each cluster and dimension. */
+        Real logLikelihood;
+        std::size_t expMismatches; /*!< Values replaced by the checked exp mode. */
+    };
+
 public:
     GMModel();
 
@@ -40,23 +57,143 @@ public:
     
     unsigned int GetTrainingIterations() const;
 
+    /*! \brief Sets the convergence threshold of training and adaptation.
+     *
+     *  EM stops when the total log-likelihood over all frames changes less
+     *  than the threshold between iterations. Stepwise EM and MAP adaptation
+     *  compare the average log-likelihood per frame instead, so that the
+     *  threshold does not depend on the number of frames.
+     */
     void SetTrainingThreshold(Real threshold);
     
     Real GetTrainingThreshold() const;
 
+    /*! \brief Sets the accuracy of exp in training, adaptation and scoring.
+     *
+     *  \sa MixtureKernel::SetExpAccuracy()
+     */
+    void SetExpAccuracy(ExpAccuracy accuracy);
+
+    ExpAccuracy GetExpAccuracy() const;
+
+    /*! \brief Sets the tolerance of the checked exp mode.
+     *
+     *  \sa MixtureKernel::SetExpTolerance()
+     */
+    void SetExpTolerance(Real tolerance);
+
+    Real GetExpTolerance() const;
+
+    /*! \brief Sets the minimum posterior of a cluster accumulated by training and adaptation.
+     *
+     *  A frame only contributes to the statistics of clusters whose posterior
+     *  is at least the threshold. With many clusters most posteriors of a frame
+     *  are negligible.
+     *
+     *  \param threshold The minimum posterior, 0 to accumulate all clusters.
+     */
+    void SetPosteriorThreshold(Real threshold);
+
+    Real GetPosteriorThreshold() const;
+
+    /*! \brief Sets the number of frames in each mini-batch of stepwise EM.
+     *
+     *  With a batch size above zero Train() runs stepwise EM instead of EM.
+     *  Frames are visited in shuffled order and the statistics of each batch
+     *  are blended into running statistics with the step size
+     *  (k + offset)^-exponent before an M-step, where k is the batch index.
+     *  The clusters are initialized from the frames of at most
+     *  INITIAL_BATCH_COUNT batches, so neither the initialization nor an
+     *  iteration depends on the number of training frames.
+     *
+     *  \param batchSize The number of frames, 0 for EM over all frames.
+     */
+    void SetBatchSize(unsigned int batchSize);
+
+    unsigned int GetBatchSize() const;
+
+    /*! \brief Sets the number of mini-batches in each iteration of stepwise EM.
+     *
+     *  With a fixed count the cost of an iteration does not depend on the
+     *  number of training frames. Defaults to DEFAULT_BATCH_COUNT.
+     *
+     *  \param batchCount The number of batches, 0 for one pass over all frames.
+     */
+    void SetBatchCount(unsigned int batchCount);
+
+    unsigned int GetBatchCount() const;
+
+    /*! \brief Sets the offset of the step size schedule of stepwise EM.
+     *
+     *  \param offset At least 1.0, so that the first step replaces the initial statistics.
+     */
+    void SetStepOffset(Real offset);
+
+    Real GetStepOffset() const;
+
+    /*! \brief Sets the exponent of the step size schedule of stepwise EM.
+     *
+     *  \param exponent In (0.5, 1.0], smaller values forget old batches faster.
+     */
+    void SetStepExponent(Real exponent);
+
+    Real GetStepExponent() const;
+
     void Init();
 
     const std::vector<Cluster>& GetClusters() const;
 
     /*! \brief Trains the model.
      */
-    virtual void Train(const std::vector< DynamicVector<Real> >& samples, unsigned int iterations) override;
+    virtual void Train(const FrameView& samples, unsigned int iterations) override;
     
     /*! \brief Maximum a Posteriori adaptation.
      */
-    virtual void Adapt(const std::shared_ptr<Model>& other, const std::vector< DynamicVector<Real> >& samples,
+    virtual void Adapt(const std::shared_ptr<Model>& other, const FrameView& samples,
                unsigned int iterations = 2, Real relevanceFactor = 16.0f) override;
 
+    /*! \brief Closed-form Maximum a Posteriori adaptation of the means from precomputed statistics.
+     *
+     *  Equal to one iteration of Adapt() over the frames the statistics were
+     *  accumulated from with other.
+     *
+     *  \param statistics Statistics accumulated against other with Accumulate().
+     */
+    void Adapt(const std::shared_ptr<Model>& other, const BaumWelchStatistics& statistics, Real relevanceFactor);
+
+    /*! \brief Accumulates the Baum-Welch statistics of samples against this model.
+     *
+     *  Posteriors use the exp accuracy and posterior threshold of this model.
+     *
+     *  The frames are accumulated in parallel like in the E-step.
+     *
+     *  \param statistics Statistics resized to GetOrder() components and GetDimensionCount() dimensions.
+     *  \param topCount If above zero, the posteriors of each frame are computed
+     *                  over its topCount best components only.
+     */
+    void Accumulate(const FrameView& samples, BaumWelchStatistics& statistics, unsigned int topCount = 0) const;
+
+    /*! \brief Reduces the number of clusters of a trained model.
+     *
+     *  Clusters with a weight below minimumWeight are dropped first and the
+     *  remaining weights are renormalized. Then the pair of clusters with the
+     *  lowest merge cost is merged repeatedly by moment matching: the merged
+     *  cluster has the weight, mean and variances of the pair combined. The
+     *  cost of a merge is Runnalls' upper bound on the Kullback-Leibler
+     *  divergence it causes,
+     *
+     *  0.5 * ((w_i + w_j) * log|S_ij| - w_i * log|S_i| - w_j * log|S_j|)
+     *
+     *  so near-duplicate and light clusters are merged first. Scoring and
+     *  adaptation cost are linear in the number of clusters.
+     *
+     *  \param order The target number of clusters.
+     *  \param lossBudget Merging stops before the summed merge costs would exceed this.
+     *  \param minimumWeight Clusters with a lower weight are dropped, 0 to keep all.
+     *  \return The summed cost of the merges.
+     */
+    Real Reduce(unsigned int order, Real lossBudget = std::numeric_limits<Real>::max(), Real minimumWeight = 0.0f);
+
     /*! \brief Calculates the normalized log-likelihood value over given samples.
      *
      *  The normalization is done by averaging log-likelihoods by dividing
@@ -65,7 +202,31 @@ public:
      *  \param samples Samples of independent observations.
      *  \return Normalized log-likelihood.
      */
-    Real GetLogLikelihood(const std::vector< DynamicVector<Real> >& samples) const;
+    Real GetLogLikelihood(const FrameView& samples) const;
+
+    /*! \brief Calculates the normalized log-likelihood value using a caller-owned workspace.
+     */
+    Real GetLogLikelihood(const FrameView& samples, ScoringWorkspace& workspace) const;
+
+    /*! \brief Selects the components with the highest likelihoods of each frame.
+     *
+     *  Used with a background model to score the models adapted from it
+     *  with only the selected components, see GetLogLikelihood().
+     *
+     *  \param components Filled with topCount component indices for each frame.
+     *  \return The normalized log-likelihood over all components.
+     */
+    Real SelectTopComponents(const FrameView& samples, unsigned int topCount,
+                             std::vector<unsigned int>& components, ScoringWorkspace& workspace) const;
+
+    /*! \brief Calculates the normalized log-likelihood using only selected components of each frame.
+     *
+     *  \param components Component indices from SelectTopComponents() of a model with the same order.
+     */
+    Real GetLogLikelihood(const FrameView& samples, const std::vector<unsigned int>& components, unsigned int topCount) const;
+
+    using Model::GetScore;
+    using Model::GetLogScore;
     
     /*! \brief Scores given samples.
      *
@@ -73,9 +234,9 @@ public:
      *  \return Average score over samples.
      *  \sa GetLogLikelihood()
      */
-    virtual Real GetScore(const std::vector< DynamicVector<Real> >& samples) const override;
+    virtual Real GetScore(const FrameView& samples, ScoringWorkspace& workspace) const override;
     
-    virtual Real GetLogScore(const std::vector< DynamicVector<Real> >& samples) const override;
+    virtual Real GetLogScore(const FrameView& samples, ScoringWorkspace& workspace) const override;
     
     virtual unsigned int GetDimensionCount() const override;
 
@@ -84,51 +245,109 @@ private:
      *
      *  \param samples Samples of independent observations.
      */
-    void InitClusters(const std::vector< DynamicVector<Real> >& samples);
+    void InitClusters(const FrameView& samples);
 
     /*! \brief The main Expectation-Maximization algorithm.
      *
      *  \param samples Samples of independent observations.
      */
-    void EM(const std::vector< DynamicVector<Real> >& samples);
+    void EM(const FrameView& samples);
+
+    /*! \brief Stepwise EM over shuffled mini-batches.
+     *
+     *  Initializes the clusters and runs at most GetTrainingIterations() iterations
+     *  of GetBatchCount() batches.
+     *
+     *  \param samples Samples of independent observations.
+     */
+    void MiniBatchEM(const FrameView& samples);
 
     /*! \brief The E-step of the EM-algorithm.
+     *
+     *  The frames are split into GetThreadCount() contiguous ranges that are
+     *  accumulated in parallel and summed in range order, so the result only
+     *  depends on the thread count.
      *
      *  \param samples Samples of independent observations.
+     *  \param squares False to skip the sums of squares, which MAP adaptation does not need.
+     *  \param statistics Set to the statistics of samples.
      *  \return Log-likelihood over samples.
      */
-    Real E(const std::vector< DynamicVector<Real> >& samples);
+    Real E(const FrameView& samples, bool squares, Statistics& statistics) const;
 
-    /*! \brief The M-step of the EM-algorithm.
+    /*! \brief Returns the number of frame ranges accumulated in parallel.
+     */
+    unsigned int GetRangeCount(unsigned int frameCount) const;
+
+    /*! \brief Accumulates the E-step statistics of the frames [begin, end).
+     */
+    void AccumulateStatistics(const FrameView& samples, unsigned int begin, unsigned int end,
+                              bool squares, Statistics& statistics) const;
+
+    /*! \brief Accumulates the Baum-Welch statistics of samples on the calling thread.
      *
-     *  \param samples Samples of independent observations.
+     *  \param mismatches Incremented for each value the checked exp mode replaced.
      */
-    void M(const std::vector< DynamicVector<Real> >& samples);
+    void AccumulateFrames(const FrameView& samples, BaumWelchStatistics& statistics, unsigned int topCount,
+                          std::size_t& mismatches) const;
 
-private:
-    /*! \brief Calculates the log-likelihood of the given sample
-     *         using given cluster values.
+    /*! \brief Returns the cost of merging two clusters.
+     *
+     *  \sa Reduce()
+     */
+    Real GetMergeCost(const Cluster& a, const Cluster& b, Real logDeterminantA, Real logDeterminantB) const;
+
+    /*! \brief Merges a cluster into another by moment matching.
+     */
+    void MergeClusters(Cluster& target, const Cluster& other) const;
+
+    /*! \brief Returns sum(log(variances)) of a cluster.
+     */
+    Real GetLogDeterminant(const Cluster& cluster) const;
+
+    /*! \brief The M-step of the EM-algorithm.
      *
-     *  \param values Feature values.
-     *  \param cluster A cluster that defines the pdf.
-     *  \return Log-likelihood
+     *  \param frameCount The number of frames the statistics were accumulated over.
      */
-    Real GetLogLikelihood(const DynamicVector<Real>& values, const Cluster& cluster) const;
+    void M(Real frameCount, const Statistics& statistics);
 
+private:
     /*! \brief Precalculates constant pdf values for efficiency.
      *
      *  \param cluster A cluster to be modifed.
      */
     void UpdatePDF(Cluster& cluster);
 
+    /*! \brief Copies the clusters of another model and updates the kernel.
+     */
+    void CopyClusters(const GMModel& model);
+
+    /*! \brief Copies the cluster parameters to the scoring kernel.
+     *
+     *  Must be called after the clusters have been modified.
+     */
+    void UpdateKernel();
+
 private:
     unsigned int mTrainingIterations;
     
     Real mEta;
 
+    Real mPosteriorThreshold;
+
+    unsigned int mBatchSize;
+
+    unsigned int mBatchCount;
+
+    Real mStepOffset;
+
+    Real mStepExponent;
+
     bool mValid;
 
-    mutable std::vector<Cluster> mClusters;
+    std::vector<Cluster> mClusters;
+
+    MixtureKernel mKernel;
 };
 
 #endif
@@ -0,0 +1,89 @@
+#ifndef _GMMODELBANK_H_
+#define _GMMODELBANK_H_
+
+#include "Common.h"
+
+#include "GMModel.h"
+
+/*! \brief Scores several Gaussian mixture models that share variances and weights.
+ *
+ *  GMModel::Adapt() adapts only the means, so all speaker models adapted from
+ *  one background model share its precisions and weights. With P and w shared,
+ *
+ *  log(w_c * N(x | mu_sc, P_c)) = [log(w_c) + K_c - 0.5 * sum(x^2 * P_c)]
+ *                                 + [-0.5 * sum(mu_sc^2 * P_c)] + x . (mu_sc * P_c)
+ *
+ *  The first term is computed once per frame and component for all models,
+ *  the second once per model and component, and the last as a matrix product
+ *  of the frames and the precision-scaled means of all models.
+ */
+class GMModelBank
+{
+public:
+    /*! \brief The number of mean rows multiplied with a buffer of frames at once.
+     *
+     *  Models are scored in tiles of whole models with about this many rows,
+     *  so the workspace does not grow with the number of models.
+     */
+    static const unsigned int TILE_ROWS = 256;
+
+public:
+    GMModelBank();
+
+    virtual ~GMModelBank();
+
+    /*! \brief Builds the bank from models.
+     *
+     *  The exp accuracy and tolerance of the first model are used for all models.
+     *
+     *  \return False if the models do not have the same order and dimensions
+     *          and the same variances and weights.
+     */
+    bool Build(const std::vector<const GMModel*>& models);
+
+    unsigned int GetModelCount() const;
+
+    /*! \brief Calculates the normalized log-likelihood of each model over the samples.
+     *
+     *  \param logLikelihoods Filled with GetModelCount() values in model order.
+     *  \sa GMModel::GetLogLikelihood()
+     */
+    void GetLogLikelihoods(const FrameView& samples, std::vector<Real>& logLikelihoods, ScoringWorkspace& workspace) const;
+
+    /*! \brief Calculates the normalized log-likelihood of selected models over the samples.
+     *
+     *  \param models Indices of the scored models, consecutive indices are scored together.
+     *  \param logLikelihoods Filled with one value for each index in models.
+     */
+    void GetLogLikelihoods(const FrameView& samples, const std::vector<unsigned int>& models,
+                           std::vector<Real>& logLikelihoods, ScoringWorkspace& workspace) const;
+
+    /*! \brief Returns true if two models have the same order, dimensions, variances and weights.
+     */
+    static bool IsSharedStructure(const GMModel& a, const GMModel& b);
+
+private:
+    unsigned int mModelCount;
+
+    unsigned int mComponentCount;
+
+    /*! \brief The distance between the scaled means of consecutive components.
+     */
+    unsigned int mStride;
+
+    /*! \brief Scores log(w_c) + K_c - 0.5 * sum(x^2 * P_c), a mixture with zero means.
+     *
+     *  Also evaluates the log-sum-exp of each model with the exp accuracy of the models.
+     */
+    MixtureKernel mSharedKernel;
+
+    /*! \brief mu_sc * P_c of each model and component, zero padded to mStride.
+     */
+    std::vector<Real, AlignedAllocator<Real, FrameMatrix::ALIGNMENT> > mScaledMeans;
+
+    /*! \brief -0.5 * sum(mu_sc^2 * P_c) of each model and component.
+     */
+    std::vector<Real> mMeanTerms;
+};
+
+#endif
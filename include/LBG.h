@@ -3,7 +3,9 @@
 
 #include "Common.h"
 
+#include "CentroidAssignment.h"
 #include "DynamicVector.h"
+#include "FrameMatrix.h"
 
 /*! \brief Linde-Buzo-Gray algorithm for clustering.
  */
@@ -25,6 +27,14 @@ public:
     
     unsigned int GetClusterCount() const;
 
+    /*! \brief Enables or disables skipping distances with triangle inequality bounds.
+     *
+     *  The clusters are the same either way, see CentroidAssignment.
+     */
+    void SetBoundsEnabled(bool enabled);
+
+    bool IsBoundsEnabled() const;
+
     /*! \brief Clusters given samples.
      *
      *  \param samples A vector of samples.
@@ -35,7 +45,7 @@ public:
      *  \note Given containers will be resized if necessary.
      */
     void Cluster(
-        const std::vector< DynamicVector<Real> >& samples,
+        const FrameView& samples,
         std::vector<unsigned int>& indices,
         std::vector< DynamicVector<Real> >& centroids,
         std::vector<unsigned int>& sizes);
@@ -51,6 +61,8 @@ private:
     unsigned int mClusterCount;
 
     Real mEta;
+
+    bool mBoundsEnabled;
 };
 
 #endif
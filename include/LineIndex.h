@@ -0,0 +1,76 @@
+#ifndef _LINEINDEX_H_
+#define _LINEINDEX_H_
+
+#include "Common.h"
+
+#include <cstdint>
+#include <mutex>
+
+/*! \brief Byte offsets of the lines of a text file.
+ *
+ *  The index is saved next to the file as [path].idx together with the size
+ *  and modification time of the file, and rebuilt when they no longer match.
+ */
+class LineIndex
+{
+public:
+    LineIndex();
+
+    virtual ~LineIndex();
+
+    /*! \brief Loads the index of a file.
+     *
+     *  The index is rebuilt and saved if it is missing or out of date.
+     *
+     *  \return False if the file could not be read.
+     */
+    bool Load(const std::string& path);
+
+    /*! \brief Scans the file and saves the index.
+     *
+     *  \return False if the file could not be read.
+     */
+    bool Build(const std::string& path);
+
+    /*! \brief Checks that the indexed file has not changed.
+     */
+    bool IsCurrent() const;
+
+    unsigned int GetLineCount() const;
+
+    /*! \brief Returns the byte offset of a line.
+     *
+     *  \param line Line number, indexing starts from 1.
+     */
+    std::uint64_t GetLineOffset(unsigned int line) const;
+
+    /*! \brief Returns the shared, up-to-date index of a file.
+     *
+     *  This function is thread-safe.
+     *
+     *  \return nullptr if the file could not be read.
+     */
+    static std::shared_ptr<const LineIndex> Get(const std::string& path);
+
+    /*! \brief Returns the path of the index file of a file.
+     */
+    static std::string GetIndexPath(const std::string& path);
+
+private:
+    /*! \brief Reads the index file without checking it against the indexed file.
+     */
+    bool Read(const std::string& indexPath);
+
+    bool Write(const std::string& indexPath) const;
+
+private:
+    std::string mPath;
+
+    long long mSize;
+
+    long long mModificationTime;
+
+    std::vector<std::uint64_t> mLineOffsets;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef _MEANVARIANCENORMALIZER_H_
+#define _MEANVARIANCENORMALIZER_H_
+
+#include "Common.h"
+
+#include "FrameMatrix.h"
+
+/*! \brief Incremental cepstral mean and variance normalization.
+ *
+ *  The means and variances of all dimensions are accumulated in a single
+ *  pass with Welford's algorithm, so frames can be added as they arrive and
+ *  normalized with the statistics seen so far.
+ */
+class MeanVarianceNormalizer
+{
+public:
+    /*! \brief Constructor.
+     *
+     *  \param dimensionCount The number of features in each frame.
+     */
+    explicit MeanVarianceNormalizer(unsigned int dimensionCount = 0);
+
+    virtual ~MeanVarianceNormalizer();
+
+    /*! \brief Removes the accumulated statistics.
+     */
+    void Reset();
+
+    /*! \brief Removes the accumulated statistics and sets the dimension count.
+     */
+    void Reset(unsigned int dimensionCount);
+
+    unsigned int GetDimensionCount() const;
+
+    /*! \brief Returns the number of accumulated frames.
+     */
+    unsigned int GetFrameCount() const;
+
+    /*! \brief Accumulates the statistics of a frame.
+     *
+     *  \param frame GetDimensionCount() feature values.
+     */
+    void Add(const Real* frame);
+
+    /*! \brief Accumulates the statistics of frames.
+     */
+    void Add(const FrameView& frames);
+
+    Real GetMean(unsigned int dimension) const;
+
+    /*! \brief Returns the sample variance (divided by n - 1) of a dimension.
+     *
+     *  \return 0 if less than two frames have been added.
+     */
+    Real GetVariance(unsigned int dimension) const;
+
+    /*! \brief Normalizes a frame to zero mean and unit variance with the accumulated statistics.
+     *
+     *  Dimensions with zero variance are only centered.
+     */
+    void Normalize(Real* frame);
+
+    /*! \brief Normalizes the frames [begin, end) with the accumulated statistics.
+     */
+    void Normalize(FrameMatrix& frames, unsigned int begin, unsigned int end);
+
+private:
+    /*! \brief Updates the inverse deviations after new frames have been added.
+     */
+    void UpdateScales();
+
+private:
+    unsigned int mDimensionCount;
+
+    unsigned int mFrameCount;
+
+    std::vector<Real> mMeans;
+
+    /*! \brief Sums of squared differences from the mean.
+     */
+    std::vector<Real> mSquareSums;
+
+    /*! \brief Inverse deviations used by Normalize().
+     */
+    std::vector<Real> mScales;
+
+    bool mScalesValid;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef _MFCCEXTRACTOR_H_
+#define _MFCCEXTRACTOR_H_
+
+#include "Common.h"
+
+#include "FrameMatrix.h"
+#include "VoiceActivityDetector.h"
+
+class SpeechData;
+
+/*! \brief Extracts mel-frequency cepstral coefficients from audio.
+ *
+ *  The defaults match scripts/feature_extractor.py, which used the mfcc()
+ *  function of python_speech_features: 25 ms frames every 10 ms, pre-emphasis
+ *  0.97, a 512-point FFT, 26 mel filters, 13 cepstral coefficients with
+ *  liftering 22 and the first coefficient replaced by the log frame energy,
+ *  followed by deltas and delta-deltas over +-2 frames.
+ *
+ *  Extract() is const and can be called from several threads.
+ */
+class MfccExtractor
+{
+public:
+    MfccExtractor();
+
+    virtual ~MfccExtractor();
+
+    /*! \brief Sets the frame length and the step between frames in seconds.
+     */
+    void SetFraming(Real frameLength, Real frameStep);
+
+    Real GetFrameLength() const;
+
+    Real GetFrameStep() const;
+
+    /*! \brief Sets the FFT size.
+     *
+     *  Frames longer than the FFT size are truncated, as in python_speech_features.
+     *
+     *  \param fftSize A power of two.
+     */
+    void SetFftSize(unsigned int fftSize);
+
+    unsigned int GetFftSize() const;
+
+    void SetFilterCount(unsigned int filterCount);
+
+    unsigned int GetFilterCount() const;
+
+    /*! \brief Sets the number of cepstral coefficients.
+     */
+    void SetCepstrumCount(unsigned int cepstrumCount);
+
+    unsigned int GetCepstrumCount() const;
+
+    /*! \brief Sets the frequency range of the filter bank in Hz.
+     *
+     *  \param highFrequency The highest frequency, 0 for half of the sample rate.
+     */
+    void SetFrequencyRange(Real lowFrequency, Real highFrequency);
+
+    /*! \brief Sets the pre-emphasis coefficient, 0 disables pre-emphasis.
+     */
+    void SetPreemphasis(Real preemphasis);
+
+    /*! \brief Sets the cepstral lifter coefficient, 0 disables liftering.
+     */
+    void SetLifter(Real lifter);
+
+    /*! \brief Sets whether the first coefficient is replaced by the log frame energy.
+     */
+    void SetEnergyAppended(bool energyAppended);
+
+    /*! \brief Sets the number of delta orders appended to the coefficients.
+     *
+     *  \param deltaOrder 0 for none, 1 for deltas, 2 for deltas and delta-deltas.
+     */
+    void SetDeltaOrder(unsigned int deltaOrder);
+
+    unsigned int GetDeltaOrder() const;
+
+    /*! \brief Sets the number of frames on each side used to compute deltas.
+     */
+    void SetDeltaWindow(unsigned int deltaWindow);
+
+    /*! \brief Sets whether non-speech frames are removed after extraction.
+     *
+     *  Frames are classified by the first coefficient, which is the log
+     *  frame energy unless SetEnergyAppended(false) has been called.
+     */
+    void SetVoiceActivityDetection(bool enabled);
+
+    bool IsVoiceActivityDetectionEnabled() const;
+
+    /*! \brief Sets the detector used for voice activity detection.
+     */
+    void SetVoiceActivityDetector(const VoiceActivityDetector& detector);
+
+    const VoiceActivityDetector& GetVoiceActivityDetector() const;
+
+    /*! \brief Returns the number of features in each extracted frame.
+     */
+    unsigned int GetDimensionCount() const;
+
+    /*! \brief Extracts features from a signal.
+     *
+     *  \param features Cleared and filled with one utterance.
+     *  \return False if the signal is empty or the options are invalid.
+     */
+    bool Extract(const std::vector<Real>& signal, unsigned int sampleRate, FrameMatrix& features) const;
+
+    /*! \brief Extracts features from a WAVE file.
+     */
+    bool Extract(const std::string& path, FrameMatrix& features) const;
+
+private:
+    /*! \brief Returns the mel filter bank as rows of mFftSize / 2 + 1 weights.
+     */
+    std::vector<Real> GetFilterBank(unsigned int sampleRate) const;
+
+    /*! \brief Appends the deltas of the values [offset, offset + count) of each frame after them.
+     */
+    void AppendDeltas(FrameMatrix& features, unsigned int offset, unsigned int count) const;
+
+private:
+    Real mFrameLength;
+
+    Real mFrameStep;
+
+    unsigned int mFftSize;
+
+    unsigned int mFilterCount;
+
+    unsigned int mCepstrumCount;
+
+    Real mLowFrequency;
+
+    Real mHighFrequency;
+
+    Real mPreemphasis;
+
+    Real mLifter;
+
+    bool mEnergyAppended;
+
+    unsigned int mDeltaOrder;
+
+    unsigned int mDeltaWindow;
+
+    bool mVoiceActivityDetection;
+
+    VoiceActivityDetector mVoiceActivityDetector;
+};
+
+/*! \brief An audio file and the label of its utterance.
+ */
+struct AudioFile
+{
+    std::string label;
+    std::string path;
+};
+
+/*! \brief Reads a list of audio files.
+ *
+ *  Each line contains a label and a path separated by whitespace.
+ *  Relative paths are relative to the folder of the list file.
+ */
+bool LoadAudioFileList(const std::string& path, std::vector<AudioFile>& files);
+
+/*! \brief Extracts the features of audio files in parallel.
+ *
+ *  \param features One utterance for each file, in file order. Empty if extraction failed.
+ *  \return The number of files that could not be processed.
+ */
+unsigned int ExtractFeatures(const std::vector<AudioFile>& files, const MfccExtractor& extractor, std::vector<FrameMatrix>& features);
+
+/*! \brief Extracts the features of audio files and adds them to a data set.
+ *
+ *  Utterances are added in file order as samples of their labels.
+ *
+ *  \return The number of files that could not be processed.
+ */
+unsigned int ExtractFeatures(const std::vector<AudioFile>& files, const MfccExtractor& extractor, SpeechData& data);
+
+/*! \brief Extracts the features of audio files and writes them to a sample file.
+ *
+ *  Paths ending with .bin are written in the binary feature format, other
+ *  paths in the text format read by SpeechData::Load().
+ *
+ *  \return False if some file could not be processed or the output could not be written.
+ */
+bool ExtractFeatures(const std::vector<AudioFile>& files, const MfccExtractor& extractor, const std::string& outputPath);
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef _MIXTUREKERNEL_H_
+#define _MIXTUREKERNEL_H_
+
+#include "Common.h"
+
+#include "FrameMatrix.h"
+
+/*! \brief Accuracy of the exp evaluations of log-sum-exp and posteriors.
+ *
+ *  The approximations reduce the argument to r = x - k * log(2), evaluate a
+ *  polynomial of r and scale it by 2^k, several values at a time.
+ */
+enum class ExpAccuracy
+{
+    EXACT,  //!< std::exp.
+    HIGH,   //!< Relative error below 1e-14.
+    MEDIUM, //!< Relative error below 1e-8.
+    LOW     //!< Relative error below 1e-4.
+};
+
+/*! \brief Computes weighted log-likelihoods of frames under a diagonal Gaussian mixture.
+ *
+ *  The Mahalanobis term of each component is expanded as
+ *  x^2 * P - 2 * x * (mu * P) + mu^2 * P, where P is the inverse variance, and
+ *  everything that does not depend on the frame is precomputed:
+ *
+ *  log(w_c * N(x | c)) = K_c + sum_d x_d * ((mu * P)_cd - 0.5 * x_d * P_cd)
+ *
+ *  Frames are scored in blocks of BLOCK_FRAMES so that the component tables
+ *  are loaded once per block. The inner loop uses AVX-512 or AVX2 with FMA
+ *  when the translation unit is compiled with them enabled (-mavx512f or
+ *  -mavx2 -mfma, or -march=native), with a scalar fallback otherwise.
+ */
+class MixtureKernel
+{
+public:
+    /*! \brief The number of frames scored together by the inner loop.
+     */
+    static const unsigned int BLOCK_FRAMES = 4;
+
+    /*! \brief The number of frames buffered by GetLogLikelihood().
+     */
+    static const unsigned int BUFFER_FRAMES = 64;
+
+public:
+    MixtureKernel();
+
+    virtual ~MixtureKernel();
+
+    /*! \brief Sets the number of components and dimensions.
+     *
+     *  \note All components are reset to zero weight.
+     */
+    void Resize(unsigned int componentCount, unsigned int dimensionCount);
+
+    unsigned int GetComponentCount() const;
+
+    unsigned int GetDimensionCount() const;
+
+    /*! \brief Sets the parameters of a component.
+     *
+     *  \param means GetDimensionCount() means.
+     *  \param variances GetDimensionCount() variances.
+     *  \param weight The mixing coefficient.
+     */
+    void SetComponent(unsigned int component, const Real* means, const Real* variances, Real weight);
+
+    void SetExpAccuracy(ExpAccuracy accuracy);
+
+    ExpAccuracy GetExpAccuracy() const;
+
+    /*! \brief Sets the tolerance of the checked mode.
+     *
+     *  If the tolerance is above zero and the accuracy is not EXACT, each
+     *  approximated log-sum-exp and posterior is compared to the exact one.
+     *  The exact value is used and counted as a mismatch if they differ by
+     *  more than the tolerance, see ReportMismatches().
+     *
+     *  \param tolerance The maximum absolute difference, 0 to disable checking.
+     */
+    void SetExpTolerance(Real tolerance);
+
+    Real GetExpTolerance() const;
+
+    /*! \brief Computes the weighted log-likelihoods of the frames [begin, end).
+     *
+     *  \param output (end - begin) * GetComponentCount() values, one row of
+     *                component values for each frame.
+     */
+    void GetLogLikelihoods(const FrameView& samples, unsigned int begin, unsigned int end, Real* output) const;
+
+    /*! \brief Computes the average log-likelihood of the mixture over frames.
+     */
+    Real GetLogLikelihood(const FrameView& samples) const;
+
+    /*! \brief Computes the average log-likelihood of the mixture over frames.
+     *
+     *  \param buffer Scratch memory, resized as needed.
+     *  \param mismatches Incremented for each value the checked mode replaced.
+     */
+    Real GetLogLikelihood(const FrameView& samples, std::vector<Real>& buffer, std::size_t& mismatches) const;
+
+    /*! \brief Computes the weighted log-likelihood of one frame under one component.
+     */
+    Real GetLogLikelihood(const Real* frame, unsigned int component) const;
+
+    /*! \brief Selects the components with the highest weighted log-likelihoods of each frame.
+     *
+     *  \param topCount The number of components selected for each frame, at most GetComponentCount().
+     *  \param components Filled with topCount component indices for each frame, best first.
+     *  \param buffer Scratch memory, resized as needed.
+     *  \param mismatches Incremented for each value the checked mode replaced.
+     *  \return The average log-likelihood of the mixture over all components.
+     */
+    Real SelectTopComponents(const FrameView& samples, unsigned int topCount,
+                             std::vector<unsigned int>& components, std::vector<Real>& buffer,
+                             std::size_t& mismatches) const;
+
+    /*! \brief Computes the average log-likelihood of the mixture over frames using only selected components.
+     *
+     *  \param components topCount component indices for each frame, from SelectTopComponents().
+     *  \param mismatches Incremented for each value the checked mode replaced.
+     */
+    Real GetLogLikelihood(const FrameView& samples, const std::vector<unsigned int>& components, unsigned int topCount,
+                          std::size_t& mismatches) const;
+
+    /*! \brief Returns the number of values a table row of dimensionCount values is padded to.
+     */
+    static unsigned int GetPaddedSize(unsigned int dimensionCount);
+
+    /*! \brief Computes the dot products of the frames [begin, end) with rows of values.
+     *
+     *  Each frame is multiplied with all rows in blocks of BLOCK_FRAMES frames,
+     *  a matrix product of the frames and the transposed rows.
+     *
+     *  \param rows rowCount rows of samples.GetDimensionCount() values, each
+     *               zero padded to rowStride, a multiple of GetPaddedSize(1),
+     *               and aligned to FrameMatrix::ALIGNMENT bytes.
+     *  \param output (end - begin) * rowCount values, one row of products for each frame.
+     */
+    static void GetDotProducts(const FrameView& samples, unsigned int begin, unsigned int end,
+                               const Real* rows, unsigned int rowCount, unsigned int rowStride, Real* output);
+
+    /*! \brief Returns log(sum(exp(values))) of a row of component values with the configured accuracy.
+     *
+     *  \param mismatches Incremented if the checked mode replaced the approximation.
+     */
+    Real GetLogSumExp(const Real* values, unsigned int count, std::size_t& mismatches) const;
+
+    /*! \brief Computes the posteriors of a row of component values.
+     *
+     *  Components with a posterior below the threshold are skipped without
+     *  evaluating exp for them.
+     *
+     *  \param threshold The minimum posterior of a selected component.
+     *  \param posteriors Filled with the posteriors of the selected components, at most count values.
+     *  \param components Filled with the indices of the selected components, at most count values.
+     *  \param logSumExp Set to log(sum(exp(values))).
+     *  \param mismatches Incremented for each value the checked mode replaced.
+     *  \return The number of selected components.
+     */
+    unsigned int GetPosteriors(const Real* values, unsigned int count, Real threshold,
+                               Real* posteriors, unsigned int* components, Real& logSumExp,
+                               std::size_t& mismatches) const;
+
+    /*! \brief Prints a single warning about the values the checked mode replaced.
+     *
+     *  Mismatches are counted per frame and reported once per E-step or
+     *  scoring call by the thread that started it.
+     */
+    static void ReportMismatches(std::size_t mismatches);
+
+    /*! \brief Returns log(sum(exp(values))) of a row of component values.
+     */
+    static Real LogSumExp(const Real* values, unsigned int count);
+
+    /*! \brief Replaces values with their exponents.
+     *
+     *  \note The approximations expect values of at most 0, as in log-sum-exp,
+     *        and clamp values below -708 to -708.
+     */
+    static void Exp(Real* values, unsigned int count, ExpAccuracy accuracy);
+
+    /*! \brief Returns the name of the instruction set the kernel was compiled for.
+     */
+    static const char* GetInstructionSet();
+
+private:
+    unsigned int mComponentCount;
+
+    unsigned int mDimensionCount;
+
+    /*! \brief The distance between the tables of consecutive components.
+     */
+    unsigned int mStride;
+
+    ExpAccuracy mExpAccuracy;
+
+    Real mExpTolerance;
+
+    /*! \brief 0.5 * P of each component, zero padded to mStride.
+     */
+    std::vector<Real, AlignedAllocator<Real, FrameMatrix::ALIGNMENT> > mHalfPrecisions;
+
+    /*! \brief mu * P of each component, zero padded to mStride.
+     */
+    std::vector<Real, AlignedAllocator<Real, FrameMatrix::ALIGNMENT> > mScaledMeans;
+
+    /*! \brief log(w) + pdf constant - 0.5 * sum(mu^2 * P) of each component.
+     */
+    std::vector<Real> mConstants;
+};
+
+#endif
@@ -7,6 +7,23 @@
 
 #include "SpeechData.h"
 
+#include "FrameMatrix.h"
+
+/*! \brief Scratch memory of model scoring.
+ *
+ *  Models keep no per-call state, so a trained model can be scored from
+ *  several threads at once as long as each call has its own workspace.
+ *  A workspace can be reused by consecutive calls to avoid allocations.
+ */
+struct ScoringWorkspace
+{
+    std::vector<Real> values;
+
+    std::vector<Real> products; /*!< Products of frames and models when scoring several models. */
+
+    std::vector<unsigned int> components; /*!< Selected components of each frame. */
+};
+
 class Model
 {
 public:
@@ -19,18 +36,65 @@ public:
     virtual void SetOrder(unsigned int order);
 
     virtual unsigned int GetOrder() const;
+
+    /*! \brief Sets the number of threads used by training.
+     *
+     *  Results are reproducible for a fixed thread count.
+     *
+     *  \param threadCount The number of threads, 0 for all hardware threads.
+     */
+    virtual void SetThreadCount(unsigned int threadCount);
+
+    virtual unsigned int GetThreadCount() const;
+
+    /*! \brief Enables the progress dots printed by training and adaptation.
+     *
+     *  Disabled for models trained concurrently, whose output would interleave.
+     */
+    void SetProgressEnabled(bool enabled);
+
+    bool IsProgressEnabled() const;
     
-    virtual void Train(const std::vector< DynamicVector<Real> >& samples, unsigned int iterations) = 0;
+    virtual void Train(const FrameView& samples, unsigned int iterations) = 0;
     
-    virtual void Adapt(const std::shared_ptr<Model>& other, const std::vector< DynamicVector<Real> >& samples,
+    virtual void Adapt(const std::shared_ptr<Model>& other, const FrameView& samples,
                        unsigned int iterations = 2, Real relevanceFactor = 16.0f) = 0;
     
-    virtual Real GetScore(const std::vector< DynamicVector<Real> >& samples) const = 0;
+    /*! \brief Scores samples using a thread-local workspace.
+     *
+     *  Safe to call concurrently.
+     */
+    Real GetScore(const FrameView& samples) const;
+
+    Real GetLogScore(const FrameView& samples) const;
+
+    /*! \brief Scores samples using a caller-owned workspace.
+     *
+     *  Safe to call concurrently with different workspaces.
+     */
+    virtual Real GetScore(const FrameView& samples, ScoringWorkspace& workspace) const = 0;
+
+    virtual Real GetLogScore(const FrameView& samples, ScoringWorkspace& workspace) const = 0;
 
-    virtual Real GetLogScore(const std::vector< DynamicVector<Real> >& samples) const = 0;
+    /*! \brief Returns the workspace of the calling thread.
+     */
+    static ScoringWorkspace& GetThreadWorkspace();
+
+protected:
+    /*! \brief Prints the progress of a training iteration if enabled.
+     */
+    void PrintIteration() const;
+
+    /*! \brief Ends the progress line of training if enabled.
+     */
+    void EndIterations() const;
 
 private:
     unsigned int mOrder;
+
+    unsigned int mThreadCount;
+
+    bool mProgressEnabled;
 };
 
 #endif
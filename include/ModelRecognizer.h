@@ -88,6 +88,13 @@ public:
     
     unsigned int GetAdaptationIterations() const;
 
+    /*! \brief Sets the relevance factor of speaker model adaptation.
+     *
+     *  If speaker models were adapted for the factor in a relevance factor
+     *  sweep, they are selected without training.
+     *
+     *  \sa SetRelevanceFactors()
+     */
     void SetRelevanceFactor(Real factor);
     
     void SetTrainingIterations(unsigned int iterations);
@@ -100,6 +107,28 @@ public:
 
     Real GetRelevanceFactor() const;
 
+    /*! \brief Sets the relevance factors of a speaker model sweep.
+     *
+     *  When the speaker models are adapted, a model of each speaker is adapted
+     *  for every factor and the current relevance factor in a single pass, see
+     *  AdaptModels(). The models of any swept factor are then selected with
+     *  SetRelevanceFactor() without training.
+     *
+     *  \param factors The relevance factors, empty to disable the sweep.
+     */
+    void SetRelevanceFactors(const std::vector<Real>& factors);
+
+    const std::vector<Real>& GetRelevanceFactors() const;
+
+    /*! \brief Sets the number of threads used to train the models.
+     *
+     *  \param threadCount The number of threads, 0 for all hardware threads.
+     *  \sa Model::SetThreadCount()
+     */
+    void SetThreadCount(unsigned int threadCount);
+
+    unsigned int GetThreadCount() const;
+
     virtual void Train() override;
 
     virtual void SelectSpeakerModels(const std::vector<SpeakerKey>& models);
@@ -124,7 +153,7 @@ public:
      * 
      *  \return True if the recognized speaker and the given speaker match. False, otherwise.
      */
-    virtual bool IsRecognized(const SpeakerKey& speaker, const std::vector< DynamicVector<Real> >& samples);
+    virtual bool IsRecognized(const SpeakerKey& speaker, const FrameView& samples);
 
     /*! \brief Calculates a verification score for a claimed speaker based on given samples.
      *
@@ -135,7 +164,7 @@ public:
      *  If the background model is not available the raw score of the speaker will be returned and normalized
      *  if required.
      */
-    virtual Real GetVerificationScore(const SpeakerKey& speaker, const std::vector< DynamicVector<Real> >& samples);
+    virtual Real GetVerificationScore(const SpeakerKey& speaker, const FrameView& samples);
 
     /*! \brief Returns verification scores of multiple samples.
      *
@@ -146,21 +175,66 @@ public:
     virtual std::vector<Real> Verify(const SpeakerKey& speaker, const std::shared_ptr<SpeechData>& data) override;
 
 protected:
-    void TrainBackgroundModel();
+    virtual void TrainBackgroundModel();
 
+    /*! \brief Trains or adapts the model of each speaker.
+     *
+     *  With more than one thread the speakers are trained in parallel.
+     *  Speakers with many frames split their frames across the threads, the
+     *  other speakers are packed into tasks trained on a single thread each.
+     *  AdaptModel() and AdaptModels() may therefore be called concurrently.
+     */
     void TrainSpeakerModels();
 
     virtual std::shared_ptr<Model> CreateModel() = 0;
+
+    /*! \brief Creates the background model, CreateModel() by default.
+     */
+    virtual std::shared_ptr<Model> CreateBackgroundModel();
     
+    /*! \brief Adapts a speaker model from the background model.
+     *
+     *  Calls Model::Adapt() with the adaptation iterations and relevance factor.
+     */
+    virtual void AdaptModel(const std::shared_ptr<Model>& model, const SpeakerKey& speaker, const FrameView& samples);
+
+    /*! \brief Adapts a speaker model for each relevance factor of a sweep.
+     *
+     *  Calls Model::Adapt() for each model. Recognizers can override this to
+     *  share the alignment of the samples between the models.
+     */
+    virtual void AdaptModels(const std::vector<std::shared_ptr<Model> >& models, const SpeakerKey& speaker,
+                             const FrameView& samples, const std::vector<Real>& factors);
+
     /*! \brief Post-process models after training.
      */
     virtual void PrepareModels();
     
     virtual void Unprepare();
 
+    /*! \brief Marks the speaker models for retraining from the current background model.
+     */
+    void SetSpeakerModelsDirty();
+
     /*! \brief Unnormalized version of GetMultipleVerificationScore().
      */
-    virtual Real GetRatio(const std::shared_ptr<Model>& model, const std::vector< DynamicVector<Real> >& samples);
+    virtual Real GetRatio(const std::shared_ptr<Model>& model, const FrameView& samples);
+
+    /*! \brief Calculates GetRatio() of several models over the same samples.
+     *
+     *  Recognizers can override this to share work between the models.
+     */
+    virtual std::vector<Real> GetRatios(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples);
+
+    /*! \brief Calculates Model::GetScore() of several models over the same samples.
+     *
+     *  Recognizers can override this to share work between the models.
+     */
+    virtual std::vector<Real> GetScores(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples);
+
+    /*! \brief Calculates Model::GetLogScore() of several models over the same samples.
+     */
+    virtual std::vector<Real> GetLogScores(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples);
 
     virtual std::shared_ptr<Model> GetBackgroundModel();
 
@@ -176,12 +250,25 @@ protected:
 
     virtual unsigned int GetDimensionCount();
 
+private:
+    typedef std::map<SpeakerKey, std::shared_ptr<Model> > ModelCache;
+
+    /*! \brief Finds the swept models of a relevance factor.
+     */
+    std::map<Real, ModelCache>::iterator FindRelevanceModelCache(Real factor);
+
+    /*! \brief Replaces the model cache and the selected models without training.
+     */
+    void SelectModelCache(const ModelCache& cache);
+
 private:
     unsigned int mOrder;
 
     unsigned int mAdaptationIterations;
 
     Real mRelevanceFactor;
+
+    std::vector<Real> mRelevanceFactors;
     
     ScoreNormalizationType mScoreNormalizationType;
     
@@ -196,6 +283,8 @@ private:
     unsigned int mTrainingIterations;
     
     Real mEta;
+
+    unsigned int mThreadCount;
     
     unsigned int mBackgroundModelDirty;
 
@@ -209,6 +298,10 @@ private:
     
     std::map<SpeakerKey, std::shared_ptr<Model> > mModelCache;
 
+    /*! \brief The swept speaker models of each relevance factor.
+     */
+    std::map<Real, ModelCache> mRelevanceModelCaches;
+
     std::shared_ptr<SpeechData> mSpeakerData;
 
     std::shared_ptr<SpeechData> mBackgroundModelData;
@@ -0,0 +1,53 @@
+#ifndef _REALFFT_H_
+#define _REALFFT_H_
+
+#include "Common.h"
+
+#include <complex>
+
+/*! \brief Fast Fourier transform of real signals.
+ *
+ *  A real signal of N values is transformed with a complex radix-2 FFT of
+ *  N / 2 values. The tables are computed once in the constructor and the
+ *  transform functions are const, so one object can be shared by threads.
+ */
+class RealFFT
+{
+public:
+    /*! \brief Constructor.
+     *
+     *  \param size Transform size, a power of two of at least 2.
+     */
+    explicit RealFFT(unsigned int size);
+
+    virtual ~RealFFT();
+
+    unsigned int GetSize() const;
+
+    /*! \brief Transforms a real signal.
+     *
+     *  \param input GetSize() values.
+     *  \param output GetSize() / 2 + 1 coefficients of the non-negative frequencies.
+     */
+    void Transform(const Real* input, std::complex<Real>* output) const;
+
+    /*! \brief Computes the power spectrum of a real signal.
+     *
+     *  \param input GetSize() values.
+     *  \param output GetSize() / 2 + 1 squared magnitudes.
+     */
+    void GetPowerSpectrum(const Real* input, Real* output) const;
+
+private:
+    unsigned int mSize;
+
+    /*! \brief Bit reversed indices of the half size transform.
+     */
+    std::vector<unsigned int> mBitReversal;
+
+    /*! \brief exp(-2 pi i k / N) for k in [0, N / 2).
+     */
+    std::vector<std::complex<Real> > mTwiddles;
+};
+
+#endif
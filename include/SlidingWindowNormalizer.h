@@ -0,0 +1,78 @@
+#ifndef _SLIDINGWINDOWNORMALIZER_H_
+#define _SLIDINGWINDOWNORMALIZER_H_
+
+#include "Common.h"
+
+/*! \brief Online cepstral mean and variance normalization over a sliding window.
+ *
+ *  Each frame is normalized with the mean and variance of the last
+ *  GetWindowSize() frames including itself, so frames can be normalized as
+ *  soon as they arrive. The statistics are kept as running sums and updated
+ *  in O(1) per frame and dimension.
+ */
+class SlidingWindowNormalizer
+{
+public:
+    /*! \brief Constructor.
+     *
+     *  \param dimensionCount The number of features in each frame.
+     *  \param windowSize The number of frames in the window.
+     */
+    SlidingWindowNormalizer(unsigned int dimensionCount = 0, unsigned int windowSize = 300);
+
+    virtual ~SlidingWindowNormalizer();
+
+    /*! \brief Removes all frames from the window.
+     */
+    void Reset();
+
+    /*! \brief Removes all frames from the window and sets the dimension count and the window size.
+     */
+    void Reset(unsigned int dimensionCount, unsigned int windowSize);
+
+    unsigned int GetDimensionCount() const;
+
+    unsigned int GetWindowSize() const;
+
+    /*! \brief Returns the number of frames currently in the window.
+     */
+    unsigned int GetFrameCount() const;
+
+    /*! \brief Adds a frame to the window and normalizes it in place.
+     *
+     *  Dimensions with zero variance are only centered.
+     *
+     *  \param frame GetDimensionCount() feature values.
+     */
+    void Normalize(Real* frame);
+
+private:
+    /*! \brief Recomputes the running sums from the window to remove accumulated rounding errors.
+     */
+    void UpdateSums();
+
+private:
+    unsigned int mDimensionCount;
+
+    unsigned int mWindowSize;
+
+    unsigned int mFrameCount;
+
+    /*! \brief Index of the oldest frame in the window.
+     */
+    unsigned int mFirst;
+
+    /*! \brief The number of frames removed since the sums were last recomputed.
+     */
+    unsigned int mRemovedCount;
+
+    /*! \brief Original values of the frames in the window, a ring buffer of mWindowSize frames.
+     */
+    std::vector<Real> mWindow;
+
+    std::vector<Real> mSums;
+
+    std::vector<Real> mSquareSums;
+};
+
+#endif
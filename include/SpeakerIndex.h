@@ -0,0 +1,74 @@
+#ifndef _SPEAKERINDEX_H_
+#define _SPEAKERINDEX_H_
+
+#include "Common.h"
+
+#include <mutex>
+
+/*! \brief An index of the sample files in a feature folder.
+ *
+ *  For each samples_[n].txt file the index stores the speaker id (the first
+ *  three characters of the first line) and the line count. The index is saved
+ *  as [folder]/speakers.idx and rebuilt when sample files are added, removed
+ *  or modified. Line offsets are kept in the LineIndex of each file.
+ */
+class SpeakerIndex
+{
+public:
+    struct Entry
+    {
+        std::string speakerId; /*!< Empty if the file has no speaker id. */
+        unsigned int lineCount = 0;
+        long long size = 0; /*!< File size when the entry was built. */
+        long long modificationTime = 0; /*!< File modification time when the entry was built. */
+    };
+
+public:
+    SpeakerIndex();
+
+    virtual ~SpeakerIndex();
+
+    /*! \brief Loads the index of a folder.
+     *
+     *  The index is rebuilt and saved if it is missing or out of date.
+     */
+    bool Load(const std::string& folder);
+
+    /*! \brief Scans all sample files of a folder and saves the index.
+     */
+    bool Build(const std::string& folder);
+
+    /*! \brief Returns the entry of samples_[fileNumber].txt or nullptr if there is no such file.
+     */
+    const Entry* GetEntry(unsigned int fileNumber) const;
+
+    /*! \brief Returns the shared index of a folder.
+     *
+     *  The index is loaded once per folder. This function is thread-safe.
+     */
+    static std::shared_ptr<const SpeakerIndex> Get(const std::string& folder);
+
+private:
+    /*! \brief Reads the index file without checking it against the sample files.
+     */
+    bool Read(const std::string& path);
+
+    bool Write(const std::string& path) const;
+
+    /*! \brief Checks that the index matches the sample files in the folder.
+     */
+    bool IsCurrent(const std::string& folder) const;
+
+    /*! \brief Returns the numbers of all samples_[n].txt files in a folder.
+     */
+    static std::vector<unsigned int> FindSampleFiles(const std::string& folder);
+
+private:
+    /*! \brief Entries by file number. Missing files have no entry.
+     *
+     *  File numbers can be large and sparse, so the entries are not stored densely.
+     */
+    std::map<unsigned int, Entry> mEntries;
+};
+
+#endif
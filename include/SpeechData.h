@@ -3,36 +3,67 @@
 
 #include "Common.h"
 
-#include "DynamicVector.h"
+#include "FrameMatrix.h"
+#include "VoiceActivityDetector.h"
 
 #include "SpeakerKey.h"
 
-#include <streambuf>
+#include <cstdint>
 
 class SpeechData;
 
+/*! \brief Loading options encoded in a feature folder name.
+ *
+ *  Format: [folder][_f[n first coefficients]][_vad][_warp[window size]][_cmvn[window size]]
+ */
+struct FeatureFolder
+{
+    std::string path; /*!< The folder containing samples_[n].txt files. */
+    bool cmvn = false; /*!< Normalize samples of each speaker after loading. */
+    unsigned int maxFeatures = 39; /*!< The number of coefficients loaded from each frame. */
+    unsigned int cmvnWindow = 0; /*!< CMVN window size in frames, 0 normalizes over all frames of a speaker. */
+    bool warp = false; /*!< Warp the features of each utterance after loading. */
+    unsigned int warpWindow = 300; /*!< Feature warping window size in frames. */
+    bool vad = false; /*!< Remove non-speech frames by the log energy in the first coefficient. */
+};
+
+/*! \brief Parses a feature folder name.
+ *
+ *  \return False if the name is invalid.
+ */
+bool ParseFeatureFolder(const std::string& name, FeatureFolder& folder);
+
+/*! \brief Returns the path of a text sample file: [folder]/samples_[index].txt.
+ */
+std::string GetSamplesPath(const std::string& folder, unsigned int index);
+
 void LoadTextSamples(const std::string& folder, const std::shared_ptr<SpeechData>& data, unsigned int sf, unsigned int gf, unsigned int sl, unsigned int gl, unsigned int multiplier, bool train);
 
+/*! \brief Returns the speaker id of samples_[index].txt in a feature folder.
+ *
+ *  The id is looked up from the speaker index of the folder. This function is thread-safe.
+ *
+ *  \sa SpeakerIndex
+ */
 std::string GetSpeakerString(unsigned int index, const std::string& folder);
 
-struct SpeechDataBuffer : public std::streambuf
-{
-    SpeechDataBuffer(char* b, std::size_t s)
-    {
-        setg(b, b, b + s);
-    }
-};
-
 enum class FeatureNormalizationType
 {
     NONE = 0,
-    CEPSTRAL_MEAN_VARIANCE
+    CEPSTRAL_MEAN_VARIANCE,
+    SLIDING_CEPSTRAL_MEAN_VARIANCE, /*!< CMVN over a sliding window of previous frames, see SlidingWindowNormalizer. */
+    FEATURE_WARPING /*!< Warping to a normal distribution over a centered window, see FeatureWarper. */
 };
 
 /*! \brief A container for speech data of multiple speakers.
  */
 class SpeechData
 {
+public:
+    /*! \brief Minimum number of lines per block when a text file is read in parallel.
+     */
+    static const unsigned int PARALLEL_BLOCK_LINES = 32;
+
 public:
     SpeechData();
 
@@ -49,9 +80,51 @@ public:
      *  \param train If this flag is true, test specific labels will be removed.
      *  \param multiplier Tells how many lines are considered as a single line (combine multiple utterances).
      *  \note Line indexing starts from 1.
+     *
+     *  The requested lines are located with the LineIndex of the file, and
+     *  large ranges are read in parallel.
      */
     void Load(const std::string& path, unsigned int sl, unsigned int gl, unsigned multiplier, bool train, unsigned int maxFeatures, bool normalize = false, const std::string& alias = "");
+
+    /*! \brief Loads data from a binary feature file.
+     *
+     *  Takes the same parameters as the text version of Load() and produces the same data.
+     *
+     *  \return False if the file could not be opened.
+     *  \sa FeatureFile, ConvertTextSamples().
+     */
+    bool LoadBinary(const std::string& path, unsigned int sl, unsigned int gl, unsigned multiplier, bool train, unsigned int maxFeatures, bool normalize = false, const std::string& alias = "");
     
+    /*! \brief Adds an utterance to the samples of a speaker.
+     *
+     *  Frames that do not match the dimension count of the speaker's earlier frames make the data inconsistent.
+     *  \sa MfccExtractor
+     */
+    void AddUtterance(const std::string& label, const FrameView& frames);
+
+    /*! \brief Moves all samples of another data set to the end of this data set.
+     *
+     *  Samples of speakers found in both data sets are appended after the
+     *  existing samples. The collected messages of the other data set are
+     *  passed on to GetLog(). The other data set is cleared.
+     */
+    void Merge(SpeechData& other);
+
+    /*! \brief Collects the loading messages instead of printing them.
+     *
+     *  Used for data sets loaded on a worker thread, so that the messages are
+     *  printed in order when the data set is merged.
+     *
+     *  \sa Merge()
+     */
+    void SetLogDeferred(bool deferred);
+
+    bool IsLogDeferred() const;
+
+    /*! \brief Returns the stream of loading messages, std::cout unless the log is deferred.
+     */
+    std::ostream& GetLog();
+
     /*! \brief Validates loaded data.
      *
      *  Checks that data dimensions match.
@@ -81,16 +154,34 @@ public:
      */
     unsigned int GetDimensionCount() const;
     
-    void CMVN(
-        std::vector < DynamicVector<Real> >::iterator beginIt,
-        std::vector < DynamicVector<Real> >::iterator endIt);
+    /*! \brief Cepstral mean and variance normalization.
+     *
+     *  Normalizes the frames [begin, end) to zero mean and unit variance.
+     *
+     *  \sa MeanVarianceNormalizer
+     */
+    void CMVN(FrameMatrix& frames, unsigned int begin, unsigned int end);
 
-    void Normalize(
-        std::vector < DynamicVector<Real> >::iterator beginIt,
-        std::vector < DynamicVector<Real> >::iterator endIt);
+    /*! \brief Normalizes the frames [begin, end) using the current normalization type.
+     */
+    void Normalize(FrameMatrix& frames, unsigned int begin, unsigned int end);
 
+    /*! \brief Normalizes the samples of each speaker.
+     *
+     *  Speakers are normalized in parallel. Sliding window normalization
+     *  and feature warping are applied to each utterance separately.
+     */
     void Normalize();
     
+    /*! \brief Removes the non-speech frames of each utterance.
+     *
+     *  Speakers are processed in parallel, each with its own copy of the detector.
+     *
+     *  \param energyDimension The index of the log energy coefficient.
+     *  \return The number of removed frames.
+     */
+    unsigned int RemoveSilence(const VoiceActivityDetector& detector, unsigned int energyDimension = 0);
+
     /*! \brief Sets the feature normalization type.
      */
     void SetNormalizationType(FeatureNormalizationType normalizationType);
@@ -99,6 +190,12 @@ public:
      */
     FeatureNormalizationType GetNormalizationType() const;
 
+    /*! \brief Sets the window size in frames used by sliding window normalization and feature warping.
+     */
+    void SetNormalizationWindow(unsigned int windowSize);
+
+    unsigned int GetNormalizationWindow() const;
+
     /*! \brief Returns the number of loaded speakers.
      */
     unsigned int GetSpeakerCount() const;
@@ -107,20 +204,59 @@ public:
      */
     unsigned int GetTotalSampleCount() const;
 
+    /*! \brief Returns the approximate number of bytes used by the samples.
+     */
+    std::size_t GetMemoryUsage() const;
+
     /*! \brief Returns all samples identified by speaker keys.
      */
-    const std::map<SpeakerKey, std::vector<DynamicVector<Real> > >& GetSamples() const;
+    const std::map<SpeakerKey, FrameMatrix>& GetSamples() const;
+
+private:
+    /*! \brief Loads the lines [begin, end] of a text file.
+     *
+     *  \param offset Byte offset of line begin.
+     *  \param sl The first line of the whole loaded range.
+     *  \param totalLines The last line of the whole loaded range.
+     *  \sa Load()
+     */
+    void LoadLines(const std::string& path, std::uint64_t offset, unsigned int begin, unsigned int end, unsigned int sl, unsigned int totalLines, unsigned int multiplier, bool train, unsigned int maxFeatures, bool normalize, const std::string& alias);
+
+    /*! \brief Converts a label read from a file to the label used as a speaker key.
+     *
+     *  \param utterance Zero-based index of the loaded line.
+     */
+    std::string GetSpeakerLabel(const std::string& label, unsigned int utterance, unsigned int multiplier, bool train, const std::string& alias) const;
+
+    /*! \brief Adds a parsed frame to a speaker's frames.
+     *
+     *  Frames that do not match the dimension count of earlier frames are
+     *  dropped and make the data inconsistent. Empty frames are ignored.
+     *
+     *  \return True if the frame was added.
+     */
+    bool AddFrame(FrameMatrix& frames, const std::vector<Real>& values);
 
 private:
     FeatureNormalizationType mNormalizationType;
 
-    std::map<SpeakerKey, std::vector<DynamicVector<Real> > > mSamples;
+    unsigned int mNormalizationWindow;
+
+    std::map<SpeakerKey, FrameMatrix> mSamples;
 
     bool mConsistent;
 
+    bool mDimensionMismatch;
+
     unsigned int mDimensionCount;
 
     unsigned int mTotalSampleCount;
+
+    bool mLogDeferred;
+
+    /*! \brief Messages collected while the log is deferred.
+     */
+    std::ostringstream mLog;
 };
 
 #endif
@@ -4,6 +4,10 @@
 #include "Common.h"
 
 #include "ModelRecognizer.h"
+#include "MixtureKernel.h"
+#include "GMModel.h"
+
+#include "DatasetCache.h"
 
 class TestEngine
 {
@@ -44,6 +48,20 @@ private:
         bool ubm = false;
         ScoreNormalizationType scoreNormalizationType = ScoreNormalizationType::NONE;
         unsigned int order = 1;
+        unsigned int topComponents = 0;
+        bool fullCovariance = false;
+        unsigned int adaptationIterations = 2;
+        Real relevanceFactor = 16.0f;
+        std::vector<Real> relevanceFactors;
+        unsigned int adaptationTopComponents = 0;
+        ExpAccuracy expAccuracy = ExpAccuracy::EXACT;
+        Real expTolerance = 0.0f;
+        Real posteriorThreshold = 0.0f;
+        unsigned int batchSize = 0;
+        unsigned int batchCount = GMModel::DEFAULT_BATCH_COUNT;
+        Real stepExponent = 0.7f;
+        unsigned int reducedOrder = 0;
+        Real reductionLossBudget = std::numeric_limits<Real>::max();
 
         TestType type = TestType::UNKNOWN;
         
@@ -89,6 +107,9 @@ public:
 
 private:
     std::string GetLabel(const Test& test);
+
+private:
+    DatasetCache mDatasetCache;
 };
 
 #endif
@@ -0,0 +1,86 @@
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include "Common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/*! \brief A fixed-size pool of worker threads for data-parallel loops.
+ *
+ *  The calling thread takes part in the work, so loops may be nested:
+ *  a task running on a worker can start another loop without deadlocking.
+ *  Idle workers and callers waiting for their last tasks steal unclaimed
+ *  tasks from any running loop, so the threads of an outer loop with uneven
+ *  tasks help with the inner loops of the remaining tasks.
+ */
+class ThreadPool
+{
+public:
+    /*! \brief Constructor.
+     *
+     *  \param threadCount The total number of threads used by a loop, including
+     *         the calling thread. Zero means the number of hardware threads.
+     */
+    explicit ThreadPool(unsigned int threadCount = 0);
+
+    virtual ~ThreadPool();
+
+    /*! \brief Returns the total number of threads used by a loop.
+     */
+    unsigned int GetThreadCount() const;
+
+    /*! \brief Runs task(i) for each i in [0, count) and waits for all tasks to finish.
+     *
+     *  Tasks may run in any order and on any thread.
+     */
+    void ParallelFor(unsigned int count, const std::function<void(unsigned int)>& task);
+
+    /*! \brief Returns a shared pool that uses all hardware threads.
+     */
+    static ThreadPool& GetDefault();
+
+private:
+    struct Job
+    {
+        const std::function<void(unsigned int)>* task;
+
+        unsigned int count;
+
+        std::atomic<unsigned int> next; /*!< The next unclaimed task. */
+
+        unsigned int activeWorkers; /*!< Workers running tasks of this job, guarded by mMutex. */
+    };
+
+private:
+    /*! \brief Runs tasks of a job until no unclaimed tasks are left.
+     */
+    void RunTasks(Job& job);
+
+    /*! \brief Returns a queued job that still has unclaimed tasks or nullptr.
+     *
+     *  \note mMutex must be locked.
+     */
+    Job* FindJob();
+
+    void WorkerLoop();
+
+private:
+    std::vector<std::thread> mWorkers;
+
+    std::deque<Job*> mJobs;
+
+    std::mutex mMutex;
+
+    std::condition_variable mJobAvailable;
+
+    /*! \brief Notified when a job finishes or is queued, waited on by callers.
+     */
+    std::condition_variable mJobFinished;
+
+    bool mStopping;
+};
+
+#endif
@@ -28,30 +28,37 @@ public:
 
     /*! \brief Trains the model.
      */
-    virtual void Train(const std::vector< DynamicVector<Real> >& samples, unsigned int iterations) override;
+    virtual void Train(const FrameView& samples, unsigned int iterations) override;
     
     /*! \brief Trains the model using MAP adaptation.
      *
      *  MAP algorithm for adapting a speaker model. Based on: ftp://ftp.cs.joensuu.fi/franti/papers/VQMAP-SPL2008.pdf
      */
-    virtual void Adapt(const std::shared_ptr<Model>& other, const std::vector< DynamicVector<Real> >& samples,
+    virtual void Adapt(const std::shared_ptr<Model>& other, const FrameView& samples,
                        unsigned int iterations = 2, Real relevanceFactor = 12.0f) override;
     
     /*! \brief Returns squared-error distortion measure
      *  divided by the number of samples.
      */
-    Real GetDistortion(const std::vector< DynamicVector<Real> >& samples) const;
+    Real GetDistortion(const FrameView& samples) const;
     
     /*! \brief Returns similarity score using weighting feature.
      *
      * Following: Speaker Discriminative Weighting Method for VQ-based Speaker identification
      * http://www.cs.joensuu.fi/pages/tkinnu/webpage/pdf/DiscriminativeWeightingMethod.pdf
      */
-    Real GetWeightedSimilarity(const std::vector< DynamicVector<Real> >& samples) const;
+    Real GetWeightedSimilarity(const FrameView& samples) const;
     
-    virtual Real GetScore(const std::vector< DynamicVector<Real> >& samples) const override;
+    using Model::GetScore;
+    using Model::GetLogScore;
+
+    /*! \brief Scores given samples.
+     *
+     *  Vector quantization needs no scratch memory, the workspace is unused.
+     */
+    virtual Real GetScore(const FrameView& samples, ScoringWorkspace& workspace) const override;
     
-    virtual Real GetLogScore(const std::vector< DynamicVector<Real> >& samples) const override;
+    virtual Real GetLogScore(const FrameView& samples, ScoringWorkspace& workspace) const override;
     
     virtual unsigned int GetDimensionCount() const override;
 
@@ -59,8 +66,6 @@ private:
     std::vector< DynamicVector<Real> > mClusterCentroids;
     std::vector<unsigned int> mClusterSizes;
     std::vector<Real> mClusterWeights;
-    
-    mutable std::vector<unsigned int> mClusterSamples;
 };
 
 #endif
@@ -0,0 +1,109 @@
+#ifndef _VOICEACTIVITYDETECTOR_H_
+#define _VOICEACTIVITYDETECTOR_H_
+
+#include "Common.h"
+
+#include "FrameMatrix.h"
+
+/*! \brief Streaming energy based voice activity detection.
+ *
+ *  Frames are classified one at a time by their log energy. A frame is speech
+ *  if its log energy is above the absolute threshold, at least the minimum
+ *  signal to noise ratio above the quietest recent frame and no more than the
+ *  margin below the loudest recent frame. The peak and noise levels move
+ *  linearly towards each frame so that the detector adapts to level changes.
+ *  Frames within the hangover after speech are kept as speech.
+ *
+ *  The detector works either on PCM samples, replacing
+ *  scripts/silence_remover.py, or on the log energy coefficient of extracted
+ *  features.
+ */
+class VoiceActivityDetector
+{
+public:
+    VoiceActivityDetector();
+
+    virtual ~VoiceActivityDetector();
+
+    /*! \brief Sets the absolute log energy threshold.
+     *
+     *  For PCM samples the energy is the mean square of a frame, so
+     *  std::log(30000) matches scripts/silence_remover.py. The default is -infinity.
+     */
+    void SetThreshold(Real threshold);
+
+    Real GetThreshold() const;
+
+    /*! \brief Sets how far below the peak log energy speech frames may be, 0 disables the relative threshold.
+     */
+    void SetMargin(Real margin);
+
+    Real GetMargin() const;
+
+    /*! \brief Sets how far above the noise log energy speech frames must be, 0 disables the noise threshold.
+     */
+    void SetMinimumSnr(Real minimumSnr);
+
+    Real GetMinimumSnr() const;
+
+    /*! \brief Sets how much the peak log energy decays and the noise log energy rises per frame.
+     */
+    void SetAdaptationRate(Real adaptationRate);
+
+    /*! \brief Sets the number of frames kept after the last speech frame.
+     */
+    void SetHangover(unsigned int hangover);
+
+    unsigned int GetHangover() const;
+
+    /*! \brief Resets the state at the beginning of a stream.
+     */
+    void Reset();
+
+    /*! \brief Classifies the next frame of a stream by its log energy.
+     *
+     *  \return True if the frame is speech.
+     */
+    bool Process(Real logEnergy);
+
+    /*! \brief Classifies the next frame of a stream by its PCM samples.
+     */
+    bool Process(const Real* samples, unsigned int sampleCount);
+
+    /*! \brief Removes the non-speech samples of a signal.
+     *
+     *  The signal is processed as a new stream in frames of frameLength samples.
+     */
+    std::vector<Real> Filter(const std::vector<Real>& signal, unsigned int frameLength);
+
+    /*! \brief Removes the non-speech frames of each utterance in place.
+     *
+     *  Each utterance is processed as a new stream. Utterances without
+     *  speech frames are removed.
+     *
+     *  \param energyDimension The index of the log energy coefficient.
+     *  \return The number of removed frames.
+     */
+    unsigned int Filter(FrameMatrix& frames, unsigned int energyDimension);
+
+private:
+    Real mThreshold;
+
+    Real mMargin;
+
+    Real mMinimumSnr;
+
+    Real mAdaptationRate;
+
+    unsigned int mHangover;
+
+    Real mPeak;
+
+    Real mNoise;
+
+    /*! \brief Frames left in the current hangover.
+     */
+    unsigned int mHangoverLeft;
+};
+
+#endif
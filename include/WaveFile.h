@@ -0,0 +1,49 @@
+#ifndef _WAVEFILE_H_
+#define _WAVEFILE_H_
+
+#include "Common.h"
+
+/*! \brief A reader for RIFF WAVE audio files.
+ *
+ *  Supports 8, 16, 24 and 32-bit integer PCM and 32 and 64-bit float
+ *  samples. Integer samples keep their original scale, as read by
+ *  scipy.io.wavfile, so that features match the Python feature extractor.
+ */
+class WaveFile
+{
+public:
+    WaveFile();
+
+    virtual ~WaveFile();
+
+    /*! \brief Loads a file.
+     *
+     *  Multichannel files are mixed down to a single channel.
+     *
+     *  \return False if the file could not be read or the format is not supported.
+     */
+    bool Load(const std::string& path);
+
+    unsigned int GetSampleRate() const;
+
+    /*! \brief Returns the number of channels in the file.
+     */
+    unsigned int GetChannelCount() const;
+
+    /*! \brief Returns the duration in seconds.
+     */
+    Real GetDuration() const;
+
+    /*! \brief Returns the mono samples.
+     */
+    const std::vector<Real>& GetSamples() const;
+
+private:
+    unsigned int mSampleRate;
+
+    unsigned int mChannelCount;
+
+    std::vector<Real> mSamples;
+};
+
+#endif
@@ -45,8 +45,10 @@ void ANNRecognizer::Train(const SpeechData& data)
 
         mNeuronMapping[speakerIndex] = entry.first;
 
-        for (const auto& sample : entry.second)
+        for (unsigned int s = 0; s < entry.second.GetFrameCount(); s++)
         {
+            const Real* sample = entry.second[s];
+
             for (unsigned int i = 0; i < inputCount; i++)
             {
                 mTrainData.SetInput(sampleIndex, i, sample[i]);
@@ -136,11 +138,11 @@ void ANNRecognizer::Test(const SpeechData& data, std::map<SpeakerKey, Recognitio
 
         r.resize(outputCount);
 
-        for (const auto& sample : entry.second)
+        for (unsigned int s = 0; s < entry.second.GetFrameCount(); s++)
         {
-            unsigned int totalVectors = 0;
+            const Real* sample = entry.second[s];
 
-            for (unsigned int i = 0; i < sample.GetSize(); i++)
+            for (unsigned int i = 0; i < entry.second.GetDimensionCount(); i++)
             {
                 mNetwork.SetInput(i, sample[i]);
             }
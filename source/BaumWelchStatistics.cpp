@@ -0,0 +1,135 @@
+#include "BaumWelchStatistics.h"
+
+BaumWelchStatistics::BaumWelchStatistics()
+:   mComponentCount(0),
+    mDimensionCount(0),
+    mFrameCount(0),
+    mLogLikelihood(0.0f)
+{
+
+}
+
+BaumWelchStatistics::~BaumWelchStatistics()
+{
+
+}
+
+void BaumWelchStatistics::Resize(unsigned int componentCount, unsigned int dimensionCount, bool secondOrder)
+{
+    mComponentCount = componentCount;
+    mDimensionCount = dimensionCount;
+
+    mZerothOrder.resize(componentCount);
+    mFirstOrder.resize(static_cast<std::size_t>(componentCount) * dimensionCount);
+    mSecondOrder.resize(secondOrder ? static_cast<std::size_t>(componentCount) * dimensionCount : 0);
+
+    Clear();
+}
+
+void BaumWelchStatistics::Clear()
+{
+    mFrameCount = 0;
+    mLogLikelihood = 0.0f;
+
+    std::fill(mZerothOrder.begin(), mZerothOrder.end(), 0.0f);
+    std::fill(mFirstOrder.begin(), mFirstOrder.end(), 0.0f);
+    std::fill(mSecondOrder.begin(), mSecondOrder.end(), 0.0f);
+}
+
+void BaumWelchStatistics::Add(const BaumWelchStatistics& other)
+{
+    assert(other.mComponentCount == mComponentCount && other.mDimensionCount == mDimensionCount);
+    assert(other.mSecondOrder.size() == mSecondOrder.size());
+
+    mFrameCount += other.mFrameCount;
+    mLogLikelihood += other.mLogLikelihood;
+
+    for (std::size_t i = 0; i < mZerothOrder.size(); ++i)
+    {
+        mZerothOrder[i] += other.mZerothOrder[i];
+    }
+
+    for (std::size_t i = 0; i < mFirstOrder.size(); ++i)
+    {
+        mFirstOrder[i] += other.mFirstOrder[i];
+    }
+
+    for (std::size_t i = 0; i < mSecondOrder.size(); ++i)
+    {
+        mSecondOrder[i] += other.mSecondOrder[i];
+    }
+}
+
+void BaumWelchStatistics::Accumulate(const Real* frame, unsigned int component, Real posterior)
+{
+    assert(component < mComponentCount);
+
+    mZerothOrder[component] += posterior;
+
+    Real* firstOrder = &mFirstOrder[static_cast<std::size_t>(component) * mDimensionCount];
+
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        firstOrder[d] += posterior * frame[d];
+    }
+
+    if (mSecondOrder.empty())
+    {
+        return;
+    }
+
+    Real* secondOrder = &mSecondOrder[static_cast<std::size_t>(component) * mDimensionCount];
+
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        secondOrder[d] += posterior * frame[d] * frame[d];
+    }
+}
+
+void BaumWelchStatistics::AddFrame(Real logLikelihood)
+{
+    ++mFrameCount;
+    mLogLikelihood += logLikelihood;
+}
+
+unsigned int BaumWelchStatistics::GetComponentCount() const
+{
+    return mComponentCount;
+}
+
+unsigned int BaumWelchStatistics::GetDimensionCount() const
+{
+    return mDimensionCount;
+}
+
+bool BaumWelchStatistics::HasSecondOrder() const
+{
+    return !mSecondOrder.empty();
+}
+
+unsigned int BaumWelchStatistics::GetFrameCount() const
+{
+    return mFrameCount;
+}
+
+Real BaumWelchStatistics::GetLogLikelihood() const
+{
+    return mLogLikelihood;
+}
+
+Real BaumWelchStatistics::GetZerothOrder(unsigned int component) const
+{
+    return mZerothOrder[component];
+}
+
+const Real* BaumWelchStatistics::GetFirstOrder(unsigned int component) const
+{
+    return &mFirstOrder[static_cast<std::size_t>(component) * mDimensionCount];
+}
+
+const Real* BaumWelchStatistics::GetSecondOrder(unsigned int component) const
+{
+    assert(HasSecondOrder());
+
+    return &mSecondOrder[static_cast<std::size_t>(component) * mDimensionCount];
+}
@@ -0,0 +1,232 @@
+#include "CentroidAssignment.h"
+
+namespace
+{
+    /*! \brief Relative margin of the bound tests.
+     *
+     *  The bounds accumulate rounding errors, so a sample is only skipped if
+     *  its centroid is closer by a margin the errors cannot reach.
+     */
+    const Real BOUND_TOLERANCE = 1e-9;
+}
+
+CentroidAssignment::CentroidAssignment()
+    : mBoundsEnabled(true), mValid(false), mDistanceCount(0)
+{
+
+}
+
+CentroidAssignment::~CentroidAssignment()
+{
+
+}
+
+void CentroidAssignment::SetBoundsEnabled(bool enabled)
+{
+    if (enabled != mBoundsEnabled)
+    {
+        Reset();
+    }
+
+    mBoundsEnabled = enabled;
+}
+
+bool CentroidAssignment::IsBoundsEnabled() const
+{
+    return mBoundsEnabled;
+}
+
+void CentroidAssignment::Reset()
+{
+    mValid = false;
+}
+
+void CentroidAssignment::Assign(const FrameView& samples, const std::vector< DynamicVector<Real> >& centroids,
+                                unsigned int centroidCount, std::vector<unsigned int>& indices)
+{
+    unsigned int sampleCount = samples.GetFrameCount();
+
+    mDistanceCount = 0;
+
+    bool reuse = mBoundsEnabled && mValid
+        && indices.size() == sampleCount
+        && mUpperBounds.size() == sampleCount
+        && mPreviousCentroids.size() == centroidCount;
+
+    if (reuse)
+    {
+        MoveBounds(centroids, indices);
+    }
+
+    if (mBoundsEnabled)
+    {
+        UpdateCentroidDistances(centroids, centroidCount);
+    }
+
+    if (!reuse)
+    {
+        indices.resize(sampleCount);
+
+        mUpperBounds.resize(sampleCount);
+        mLowerBounds.resize(sampleCount);
+
+        for (unsigned int s = 0; s < sampleCount; ++s)
+        {
+            ++mDistanceCount;
+
+            indices[s] = Search(samples[s], centroids, centroidCount, 0, centroids[0].Distance(samples[s]), s);
+        }
+    }
+
+    else
+    {
+        for (unsigned int s = 0; s < sampleCount; ++s)
+        {
+            unsigned int c = indices[s];
+
+            Real bound = Max(mHalfDistances[c], mLowerBounds[s]) * (1.0f - BOUND_TOLERANCE);
+
+            if (mUpperBounds[s] < bound)
+            {
+                continue;
+            }
+
+            // Tighten the upper bound before searching the other centroids.
+            Real dist = centroids[c].Distance(samples[s]);
+            ++mDistanceCount;
+
+            mUpperBounds[s] = std::sqrt(dist);
+
+            if (mUpperBounds[s] < bound)
+            {
+                continue;
+            }
+
+            indices[s] = Search(samples[s], centroids, centroidCount, c, dist, s);
+        }
+    }
+
+    if (mBoundsEnabled)
+    {
+        mPreviousCentroids.assign(centroids.begin(), centroids.begin() + centroidCount);
+        mValid = true;
+    }
+}
+
+std::size_t CentroidAssignment::GetDistanceCount() const
+{
+    return mDistanceCount;
+}
+
+unsigned int CentroidAssignment::Search(const Real* sample, const std::vector< DynamicVector<Real> >& centroids,
+                                        unsigned int centroidCount, unsigned int candidate, Real candidateDist, unsigned int s)
+{
+    unsigned int minC = candidate;
+
+    Real minDist = candidateDist;
+    Real minRoot = std::sqrt(minDist);
+
+    // A lower bound of the distances to the centroids other than the closest one.
+    Real lowerBound = std::numeric_limits<Real>::max();
+
+    for (unsigned int c = 0; c < centroidCount; ++c)
+    {
+        if (c == candidate)
+        {
+            continue;
+        }
+
+        if (mBoundsEnabled)
+        {
+            Real centroidDistance = mCentroidDistances[static_cast<std::size_t>(minC) * centroidCount + c];
+
+            // d(x, c) >= d(minC, c) - d(x, minC) > d(x, minC)
+            if (0.5f * centroidDistance * (1.0f - BOUND_TOLERANCE) > minRoot)
+            {
+                lowerBound = Min(lowerBound, centroidDistance - minRoot);
+                continue;
+            }
+        }
+
+        Real dist = centroids[c].Distance(sample);
+        ++mDistanceCount;
+
+        // Ties go to the lowest index as if the centroids were compared in order.
+        if (dist < minDist || (dist == minDist && c < minC))
+        {
+            lowerBound = Min(lowerBound, minRoot);
+
+            minDist = dist;
+            minRoot = std::sqrt(dist);
+            minC = c;
+        }
+
+        else
+        {
+            lowerBound = Min(lowerBound, std::sqrt(dist));
+        }
+    }
+
+    mUpperBounds[s] = minRoot;
+    mLowerBounds[s] = lowerBound;
+
+    return minC;
+}
+
+void CentroidAssignment::MoveBounds(const std::vector< DynamicVector<Real> >& centroids, const std::vector<unsigned int>& indices)
+{
+    unsigned int centroidCount = mPreviousCentroids.size();
+
+    std::vector<Real> drifts(centroidCount);
+
+    Real maxDrift = 0.0f;
+    Real secondMaxDrift = 0.0f;
+
+    unsigned int maxC = 0;
+
+    for (unsigned int c = 0; c < centroidCount; ++c)
+    {
+        drifts[c] = std::sqrt(mPreviousCentroids[c].Distance(centroids[c]));
+
+        if (drifts[c] > maxDrift)
+        {
+            secondMaxDrift = maxDrift;
+            maxDrift = drifts[c];
+            maxC = c;
+        }
+
+        else if (drifts[c] > secondMaxDrift)
+        {
+            secondMaxDrift = drifts[c];
+        }
+    }
+
+    // The other centroids of a sample moved at most by the largest drift among them.
+    for (unsigned int s = 0; s < indices.size(); ++s)
+    {
+        unsigned int c = indices[s];
+
+        mUpperBounds[s] += drifts[c];
+        mLowerBounds[s] -= (c == maxC) ? secondMaxDrift : maxDrift;
+    }
+}
+
+void CentroidAssignment::UpdateCentroidDistances(const std::vector< DynamicVector<Real> >& centroids, unsigned int centroidCount)
+{
+    mCentroidDistances.assign(static_cast<std::size_t>(centroidCount) * centroidCount, 0.0f);
+    mHalfDistances.assign(centroidCount, std::numeric_limits<Real>::max());
+
+    for (unsigned int a = 0; a < centroidCount; ++a)
+    {
+        for (unsigned int b = a + 1; b < centroidCount; ++b)
+        {
+            Real distance = std::sqrt(centroids[a].Distance(centroids[b]));
+
+            mCentroidDistances[static_cast<std::size_t>(a) * centroidCount + b] = distance;
+            mCentroidDistances[static_cast<std::size_t>(b) * centroidCount + a] = distance;
+
+            mHalfDistances[a] = Min(mHalfDistances[a], 0.5f * distance);
+            mHalfDistances[b] = Min(mHalfDistances[b], 0.5f * distance);
+        }
+    }
+}
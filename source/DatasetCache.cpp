@@ -0,0 +1,152 @@
+#include "DatasetCache.h"
+
+#include "FeatureFile.h"
+
+bool DatasetCache::Key::operator< (const Key& rhs) const
+{
+    if (path != rhs.path) return path < rhs.path;
+    if (cmvn != rhs.cmvn) return cmvn < rhs.cmvn;
+    if (cmvnWindow != rhs.cmvnWindow) return cmvnWindow < rhs.cmvnWindow;
+    if (warp != rhs.warp) return warp < rhs.warp;
+    if (vad != rhs.vad) return vad < rhs.vad;
+    if (warpWindow != rhs.warpWindow) return warpWindow < rhs.warpWindow;
+    if (maxFeatures != rhs.maxFeatures) return maxFeatures < rhs.maxFeatures;
+
+    if (sf != rhs.sf) return sf < rhs.sf;
+    if (gf != rhs.gf) return gf < rhs.gf;
+    if (sl != rhs.sl) return sl < rhs.sl;
+    if (gl != rhs.gl) return gl < rhs.gl;
+    if (multiplier != rhs.multiplier) return multiplier < rhs.multiplier;
+    if (train != rhs.train) return train < rhs.train;
+
+    return modificationTimes < rhs.modificationTimes;
+}
+
+DatasetCache::DatasetCache(std::size_t memoryBudget)
+    : mMemoryBudget(memoryBudget),
+    mMemoryUsage(0)
+{
+
+}
+
+DatasetCache::~DatasetCache()
+{
+
+}
+
+void DatasetCache::SetMemoryBudget(std::size_t memoryBudget)
+{
+    mMemoryBudget = memoryBudget;
+
+    Evict();
+}
+
+std::size_t DatasetCache::GetMemoryBudget() const
+{
+    return mMemoryBudget;
+}
+
+std::size_t DatasetCache::GetMemoryUsage() const
+{
+    return mMemoryUsage;
+}
+
+unsigned int DatasetCache::GetSize() const
+{
+    return mEntries.size();
+}
+
+std::shared_ptr<SpeechData> DatasetCache::Load(const std::string& folder, unsigned int sf, unsigned int gf, unsigned int sl, unsigned int gl, unsigned int multiplier, bool train)
+{
+    FeatureFolder options;
+
+    if (!ParseFeatureFolder(folder, options))
+    {
+        return std::make_shared<SpeechData>();
+    }
+
+    Key key;
+    key.path = options.path;
+    key.cmvn = options.cmvn;
+    key.cmvnWindow = options.cmvnWindow;
+    key.warp = options.warp;
+    key.vad = options.vad;
+    key.warpWindow = options.warpWindow;
+    key.maxFeatures = options.maxFeatures;
+    key.sf = sf;
+    key.gf = gf;
+    key.sl = sl;
+    key.gl = gl;
+    key.train = train;
+
+    // The multiplier only affects test data.
+    key.multiplier = train ? 1 : multiplier;
+
+    for (unsigned int i = 0; i < gf; ++i)
+    {
+        std::string file = GetSamplesPath(options.path, sf + i);
+
+        key.modificationTimes.push_back(GetFileModificationTime(file));
+        key.modificationTimes.push_back(GetFileModificationTime(GetBinarySamplesPath(file)));
+    }
+
+    auto it = mEntries.find(key);
+
+    if (it != mEntries.end())
+    {
+        std::cout << "Using cached samples: " << folder << " " << sf << " " << gf << " " << sl << " " << gl << std::endl;
+
+        // Mark as the most recently used.
+        mLru.splice(mLru.begin(), mLru, it->second.lruIt);
+
+        return it->second.data;
+    }
+
+    auto data = std::make_shared<SpeechData>();
+
+    LoadTextSamples(folder, data, sf, gf, sl, gl, multiplier, train);
+
+    mLru.push_front(key);
+
+    Entry entry;
+    entry.data = data;
+    entry.size = data->GetMemoryUsage();
+    entry.lruIt = mLru.begin();
+
+    mEntries.emplace(key, entry);
+    mMemoryUsage += entry.size;
+
+    Evict();
+
+    return data;
+}
+
+void DatasetCache::Clear()
+{
+    mEntries.clear();
+    mLru.clear();
+    mMemoryUsage = 0;
+}
+
+void DatasetCache::Evict()
+{
+    auto it = mLru.end();
+
+    while (mMemoryUsage > mMemoryBudget && it != mLru.begin())
+    {
+        --it;
+
+        auto entryIt = mEntries.find(*it);
+
+        // Data sets in use are kept, they would not be freed anyway.
+        if (entryIt->second.data.use_count() > 1)
+        {
+            continue;
+        }
+
+        mMemoryUsage -= entryIt->second.size;
+        mEntries.erase(entryIt);
+
+        it = mLru.erase(it);
+    }
+}
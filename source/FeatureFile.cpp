@@ -0,0 +1,399 @@
+#include "FeatureFile.h"
+
+#include "FeatureParser.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+namespace
+{
+    const char FEATURE_FILE_MAGIC[4] = { 'S', 'R', 'F', 'F' };
+
+    const std::uint64_t FEATURE_FILE_DATA_ALIGNMENT = 64;
+}
+
+FeatureFile::FeatureFile()
+    : mData(nullptr),
+    mSize(0),
+    mHeader(nullptr)
+#ifdef _WIN32
+    , mFileHandle(INVALID_HANDLE_VALUE),
+    mMappingHandle(nullptr)
+#endif
+{
+    static_assert(sizeof(Header) == 40, "Unexpected feature file header size.");
+    static_assert(sizeof(UtteranceEntry) == LABEL_SIZE + 16, "Unexpected feature file index entry size.");
+}
+
+FeatureFile::~FeatureFile()
+{
+    Close();
+}
+
+bool FeatureFile::Open(const std::string& path)
+{
+    Close();
+
+#ifdef _WIN32
+    mFileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (mFileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(mFileHandle, &size) || size.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    mMappingHandle = CreateFileMappingA(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mMappingHandle == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    mData = static_cast<const char*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+    mSize = static_cast<std::size_t>(size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file.
+    close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    mData = static_cast<const char*>(data);
+    mSize = static_cast<std::size_t>(info.st_size);
+#endif
+
+    if (mData == nullptr || mSize < sizeof(Header))
+    {
+        std::cout << "Invalid feature file '" << path << "': missing header." << std::endl;
+        Close();
+        return false;
+    }
+
+    mHeader = reinterpret_cast<const Header*>(mData);
+
+    if (std::memcmp(mHeader->magic, FEATURE_FILE_MAGIC, sizeof(FEATURE_FILE_MAGIC)) != 0)
+    {
+        std::cout << "Invalid feature file '" << path << "': unknown format." << std::endl;
+        Close();
+        return false;
+    }
+
+    if (mHeader->version != VERSION)
+    {
+        std::cout << "Invalid feature file '" << path << "': unsupported version "
+            << mHeader->version << "." << std::endl;
+        Close();
+        return false;
+    }
+
+    // The counts come from the file, so the sizes are compared by division to avoid overflow.
+    if (   mHeader->indexOffset > mSize
+        || mHeader->utteranceCount > (mSize - mHeader->indexOffset) / sizeof(UtteranceEntry))
+    {
+        std::cout << "Invalid feature file '" << path << "': truncated index." << std::endl;
+        Close();
+        return false;
+    }
+
+    if (mHeader->dataOffset > mSize || mHeader->dataOffset % FEATURE_FILE_DATA_ALIGNMENT != 0)
+    {
+        std::cout << "Invalid feature file '" << path << "': truncated data." << std::endl;
+        Close();
+        return false;
+    }
+
+    if (mHeader->dimensionCount == 0)
+    {
+        std::cout << "Invalid feature file '" << path << "': no dimensions." << std::endl;
+        Close();
+        return false;
+    }
+
+    if (mHeader->frameCount > (mSize - mHeader->dataOffset) / (mHeader->dimensionCount * sizeof(float)))
+    {
+        std::cout << "Invalid feature file '" << path << "': truncated data." << std::endl;
+        Close();
+        return false;
+    }
+
+    for (unsigned int u = 0; u < mHeader->utteranceCount; ++u)
+    {
+        const UtteranceEntry& entry = GetEntry(u);
+
+        if (   entry.firstFrame > mHeader->frameCount
+            || entry.frameCount > mHeader->frameCount - entry.firstFrame
+            || entry.label[LABEL_SIZE - 1] != '\0')
+        {
+            std::cout << "Invalid feature file '" << path << "': corrupted index." << std::endl;
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FeatureFile::Close()
+{
+#ifdef _WIN32
+    if (mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+    }
+
+    if (mMappingHandle != nullptr)
+    {
+        CloseHandle(mMappingHandle);
+        mMappingHandle = nullptr;
+    }
+
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mFileHandle);
+        mFileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (mData != nullptr)
+    {
+        munmap(const_cast<char*>(mData), mSize);
+    }
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+    mHeader = nullptr;
+}
+
+bool FeatureFile::IsOpen() const
+{
+    return mHeader != nullptr;
+}
+
+unsigned int FeatureFile::GetDimensionCount() const
+{
+    return mHeader->dimensionCount;
+}
+
+unsigned int FeatureFile::GetUtteranceCount() const
+{
+    return mHeader->utteranceCount;
+}
+
+std::string FeatureFile::GetLabel(unsigned int utterance) const
+{
+    return std::string(GetEntry(utterance).label);
+}
+
+unsigned int FeatureFile::GetFrameCount(unsigned int utterance) const
+{
+    return GetEntry(utterance).frameCount;
+}
+
+const float* FeatureFile::GetFrames(unsigned int utterance) const
+{
+    const float* frames = reinterpret_cast<const float*>(mData + mHeader->dataOffset);
+
+    return frames + GetEntry(utterance).firstFrame * mHeader->dimensionCount;
+}
+
+const FeatureFile::UtteranceEntry& FeatureFile::GetEntry(unsigned int utterance) const
+{
+    const UtteranceEntry* entries = reinterpret_cast<const UtteranceEntry*>(mData + mHeader->indexOffset);
+
+    return entries[utterance];
+}
+
+bool FeatureFile::Write(
+    const std::string& path,
+    unsigned int dimensionCount,
+    const std::vector<std::string>& labels,
+    const std::vector<unsigned int>& frameCounts,
+    const std::vector<float>& frames)
+{
+    if (labels.size() != frameCounts.size())
+    {
+        std::cout << "Could not write feature file: label and utterance counts differ." << std::endl;
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, FEATURE_FILE_MAGIC, sizeof(FEATURE_FILE_MAGIC));
+    header.version = VERSION;
+    header.dimensionCount = dimensionCount;
+    header.utteranceCount = static_cast<std::uint32_t>(labels.size());
+    header.frameCount = (dimensionCount > 0) ? frames.size() / dimensionCount : 0;
+    header.indexOffset = sizeof(Header);
+
+    std::uint64_t indexEnd = header.indexOffset + labels.size() * sizeof(UtteranceEntry);
+    header.dataOffset = (indexEnd + FEATURE_FILE_DATA_ALIGNMENT - 1) / FEATURE_FILE_DATA_ALIGNMENT * FEATURE_FILE_DATA_ALIGNMENT;
+
+    std::vector<UtteranceEntry> entries(labels.size());
+
+    std::uint64_t firstFrame = 0;
+
+    for (unsigned int u = 0; u < labels.size(); ++u)
+    {
+        if (labels[u].size() >= LABEL_SIZE)
+        {
+            std::cout << "Could not write feature file: label '" << labels[u] << "' is too long." << std::endl;
+            return false;
+        }
+
+        std::memset(&entries[u], 0, sizeof(UtteranceEntry));
+        std::memcpy(entries[u].label, labels[u].c_str(), labels[u].size());
+
+        entries[u].firstFrame = firstFrame;
+        entries[u].frameCount = frameCounts[u];
+
+        firstFrame += frameCounts[u];
+    }
+
+    if (firstFrame != header.frameCount)
+    {
+        std::cout << "Could not write feature file: frame counts do not match the data." << std::endl;
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    if (!file)
+    {
+        std::cout << "Could not open '" << path << "' for writing." << std::endl;
+        return false;
+    }
+
+    std::vector<char> padding(header.dataOffset - indexEnd, 0);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(UtteranceEntry));
+    file.write(padding.data(), padding.size());
+    file.write(reinterpret_cast<const char*>(frames.data()), frames.size() * sizeof(float));
+
+    return file.good();
+}
+
+std::string GetBinarySamplesPath(const std::string& textPath)
+{
+    std::size_t dot = textPath.find_last_of('.');
+    std::size_t slash = textPath.find_last_of("/\\");
+
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        return textPath + ".bin";
+    }
+
+    return textPath.substr(0, dot) + ".bin";
+}
+
+bool ConvertTextSamples(const std::string& textPath, const std::string& binaryPath)
+{
+    std::ifstream file(textPath);
+
+    if (!file)
+    {
+        std::cout << "Could not open '" << textPath << "'." << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> labels;
+    std::vector<unsigned int> frameCounts;
+    std::vector<float> frames;
+
+    unsigned int dimensionCount = 0;
+
+    std::string line;
+
+    std::vector<float> frame;
+
+    while (std::getline(file, line))
+    {
+        FeatureParser parser(line);
+
+        std::string label;
+
+        labels.emplace_back();
+        frameCounts.push_back(0);
+
+        // Lines without a label are kept so that line numbers stay valid.
+        if (!parser.ReadLabel(label))
+        {
+            continue;
+        }
+
+        labels.back() = label;
+
+        while (parser.ReadFrame<float>(frame))
+        {
+            if (frame.empty())
+            {
+                continue;
+            }
+
+            if (dimensionCount == 0)
+            {
+                dimensionCount = frame.size();
+            }
+
+            if (frame.size() != dimensionCount)
+            {
+                std::cout << "Could not convert '" << textPath << "': feature count mismatch on line "
+                    << labels.size() << "." << std::endl;
+                return false;
+            }
+
+            frames.insert(frames.end(), frame.begin(), frame.end());
+
+            ++frameCounts.back();
+        }
+
+        if (parser.HasError())
+        {
+            std::cout << "Could not convert '" << textPath << "': invalid feature on line "
+                << labels.size() << "." << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "Converting '" << textPath << "' to '" << binaryPath << "': "
+        << labels.size() << " lines, " << dimensionCount << " dimensions." << std::endl;
+
+    return FeatureFile::Write(binaryPath, dimensionCount, labels, frameCounts, frames);
+}
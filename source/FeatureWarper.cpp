@@ -0,0 +1,112 @@
+#include "FeatureWarper.h"
+
+FeatureWarper::FeatureWarper(unsigned int windowSize)
+    : mWindowSize(Max(windowSize, 1u))
+{
+
+}
+
+FeatureWarper::~FeatureWarper()
+{
+
+}
+
+void FeatureWarper::SetWindowSize(unsigned int windowSize)
+{
+    mWindowSize = Max(windowSize, 1u);
+}
+
+unsigned int FeatureWarper::GetWindowSize() const
+{
+    return mWindowSize;
+}
+
+void FeatureWarper::Warp(FrameMatrix& frames, unsigned int begin, unsigned int end)
+{
+    for (unsigned int d = 0; d < frames.GetDimensionCount(); ++d)
+    {
+        Warp(frames, begin, end, d);
+    }
+}
+
+void FeatureWarper::Warp(FrameMatrix& frames, unsigned int begin, unsigned int end, unsigned int dimension)
+{
+    unsigned int frameCount = end - begin;
+
+    if (frameCount == 0)
+    {
+        return;
+    }
+
+    // Replace the values by their indices in the sorted distinct values.
+    mSortedValues.resize(frameCount);
+
+    for (unsigned int f = 0; f < frameCount; ++f)
+    {
+        mSortedValues[f] = frames[begin + f][dimension];
+    }
+
+    std::sort(mSortedValues.begin(), mSortedValues.end());
+    mSortedValues.erase(std::unique(mSortedValues.begin(), mSortedValues.end()), mSortedValues.end());
+
+    mIndices.resize(frameCount);
+
+    for (unsigned int f = 0; f < frameCount; ++f)
+    {
+        mIndices[f] = std::lower_bound(mSortedValues.begin(), mSortedValues.end(), frames[begin + f][dimension]) - mSortedValues.begin();
+    }
+
+    mTree.assign(mSortedValues.size() + 1, 0);
+
+    // The window of frame t is [t - half, t - half + mWindowSize) truncated to the range.
+    long long half = mWindowSize / 2;
+
+    unsigned int windowBegin = 0;
+    unsigned int windowEnd = 0;
+
+    for (unsigned int t = 0; t < frameCount; ++t)
+    {
+        unsigned int targetBegin = static_cast<unsigned int>(Max(static_cast<long long>(t) - half, 0ll));
+        unsigned int targetEnd = static_cast<unsigned int>(Min(static_cast<long long>(t) - half + mWindowSize, static_cast<long long>(frameCount)));
+
+        for (; windowEnd < targetEnd; ++windowEnd)
+        {
+            Update(mIndices[windowEnd], 1);
+        }
+
+        for (; windowBegin < targetBegin; ++windowBegin)
+        {
+            Update(mIndices[windowBegin], -1);
+        }
+
+        unsigned int index = mIndices[t];
+        unsigned int less = GetCount(index);
+        unsigned int equal = GetCount(index + 1) - less;
+
+        // Tied values get their average rank.
+        Real rank = less + (equal + 1) * 0.5;
+        Real count = windowEnd - windowBegin;
+
+        frames[begin + t][dimension] = InverseNormalCDF((rank - 0.5) / count);
+    }
+}
+
+void FeatureWarper::Update(unsigned int index, int count)
+{
+    for (unsigned int i = index + 1; i < mTree.size(); i += i & (~i + 1))
+    {
+        mTree[i] += count;
+    }
+}
+
+unsigned int FeatureWarper::GetCount(unsigned int index) const
+{
+    unsigned int count = 0;
+
+    for (unsigned int i = index; i > 0; i -= i & (~i + 1))
+    {
+        count += mTree[i];
+    }
+
+    return count;
+}
@@ -0,0 +1,594 @@
+#include "FullGMModel.h"
+#include "LBG.h"
+#include "MixtureKernel.h"
+#include "ThreadPool.h"
+
+namespace
+{
+    /*! \brief The smallest variance of a dimension, as in GMModel::M().
+     */
+    const Real VARIANCE_FLOOR = 1.0e-5f;
+
+    /*! \brief The number of times the diagonal is increased before a factorization is given up.
+     */
+    const unsigned int CHOLESKY_ATTEMPTS = 16;
+}
+
+FullGMModel::FullGMModel()
+: mDimensionCount(0),
+  mTrainingIterations(75),
+  mEta(0.001f)
+{
+
+}
+
+FullGMModel::~FullGMModel()
+{
+
+}
+
+void FullGMModel::SetTrainingThreshold(Real threshold)
+{
+    mEta = threshold;
+}
+
+Real FullGMModel::GetTrainingThreshold() const
+{
+    return mEta;
+}
+
+const std::vector<FullGMModel::Component>& FullGMModel::GetComponents() const
+{
+    return mComponents;
+}
+
+void FullGMModel::Train(const FrameView& samples, unsigned int iterations)
+{
+    mTrainingIterations = iterations;
+    mDimensionCount = samples.GetDimensionCount();
+
+    if (samples.GetFrameCount() == 0)
+    {
+        return;
+    }
+
+    InitComponents(samples);
+
+    Real logLikelihood = 0.0f;
+
+    for (unsigned int e = 0; e < mTrainingIterations; ++e)
+    {
+        Statistics statistics;
+
+        Real newLogLikelihood = E(samples, true, statistics);
+
+        M(statistics, samples.GetFrameCount());
+
+        if (std::abs(logLikelihood - newLogLikelihood) / samples.GetFrameCount() < mEta)
+        {
+            break;
+        }
+
+        logLikelihood = newLogLikelihood;
+
+        PrintIteration();
+    }
+
+    EndIterations();
+}
+
+void FullGMModel::Adapt(const std::shared_ptr<Model>& other, const FrameView& samples,
+                        unsigned int iterations, Real relevanceFactor)
+{
+    const FullGMModel* model = dynamic_cast<FullGMModel*>(other.get());
+
+    if (model == nullptr)
+    {
+        std::cout << "Not FullGMModel." << std::endl;
+        return;
+    }
+
+    SetOrder(other->GetOrder());
+
+    mDimensionCount = model->mDimensionCount;
+    mComponents = model->mComponents;
+
+    if (samples.GetFrameCount() == 0)
+    {
+        return;
+    }
+
+    Real logLikelihood = 0.0f;
+
+    for (unsigned int e = 0; e < iterations; ++e)
+    {
+        Statistics statistics;
+
+        Real newLogLikelihood = E(samples, false, statistics);
+
+        for (unsigned int c = 0; c < mComponents.size(); ++c)
+        {
+            Real n = statistics.probabilitySums[c];
+
+            // A component without accumulated frames keeps its mean.
+            if (n <= 0.0f)
+            {
+                continue;
+            }
+
+            Real adaptionCoeff = n / (n + relevanceFactor);
+
+            const Real* meanSums = &statistics.meanSums[static_cast<std::size_t>(c) * mDimensionCount];
+
+            for (unsigned int d = 0; d < mDimensionCount; ++d)
+            {
+                mComponents[c].means[d] = adaptionCoeff * (meanSums[d] / n) + (1.0f - adaptionCoeff) * mComponents[c].means[d];
+            }
+        }
+
+        if (std::abs(logLikelihood - newLogLikelihood) / samples.GetFrameCount() < mEta)
+        {
+            break;
+        }
+
+        logLikelihood = newLogLikelihood;
+
+        PrintIteration();
+    }
+
+    EndIterations();
+}
+
+Real FullGMModel::GetLogLikelihood(const FrameView& samples, ScoringWorkspace& workspace) const
+{
+    if (samples.GetFrameCount() == 0 || mComponents.empty())
+    {
+        return 0.0;
+    }
+
+    unsigned int componentCount = mComponents.size();
+
+    workspace.values.resize(static_cast<std::size_t>(BLOCK_FRAMES) * componentCount);
+    workspace.products.resize(static_cast<std::size_t>(2) * mDimensionCount * BLOCK_FRAMES);
+
+    Real result = 0.0;
+    Real invN = 1.0 / static_cast<Real>(samples.GetFrameCount());
+
+    for (unsigned int begin = 0; begin < samples.GetFrameCount(); begin += BLOCK_FRAMES)
+    {
+        unsigned int end = Min(begin + BLOCK_FRAMES, samples.GetFrameCount());
+
+        GetLogLikelihoods(samples, begin, end, workspace.products.data(), workspace.values.data());
+
+        for (unsigned int n = begin; n < end; ++n)
+        {
+            result += MixtureKernel::LogSumExp(&workspace.values[static_cast<std::size_t>(n - begin) * componentCount], componentCount) * invN;
+        }
+    }
+
+    return result;
+}
+
+Real FullGMModel::GetScore(const FrameView& samples, ScoringWorkspace& workspace) const
+{
+    return std::exp(GetLogScore(samples, workspace));
+}
+
+Real FullGMModel::GetLogScore(const FrameView& samples, ScoringWorkspace& workspace) const
+{
+    return GetLogLikelihood(samples, workspace);
+}
+
+unsigned int FullGMModel::GetDimensionCount() const
+{
+    return mDimensionCount;
+}
+
+void FullGMModel::GetLogLikelihoods(const FrameView& samples, unsigned int begin, unsigned int end, Real* block, Real* output) const
+{
+    assert(end - begin <= BLOCK_FRAMES);
+    assert(samples.GetDimensionCount() == mDimensionCount);
+
+    unsigned int frameCount = end - begin;
+    unsigned int componentCount = mComponents.size();
+
+    Real* frames = block;
+    Real* solutions = block + static_cast<std::size_t>(mDimensionCount) * BLOCK_FRAMES;
+
+    // Transpose so that each dimension of the block is contiguous, a partial
+    // block is padded with zero frames whose results are discarded.
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        Real* row = frames + static_cast<std::size_t>(d) * BLOCK_FRAMES;
+
+        for (unsigned int f = 0; f < frameCount; ++f)
+        {
+            row[f] = samples[begin + f][d];
+        }
+
+        for (unsigned int f = frameCount; f < BLOCK_FRAMES; ++f)
+        {
+            row[f] = 0.0;
+        }
+    }
+
+    Real squares[BLOCK_FRAMES];
+
+    for (unsigned int c = 0; c < componentCount; ++c)
+    {
+        const Component& component = mComponents[c];
+
+        for (unsigned int f = 0; f < BLOCK_FRAMES; ++f)
+        {
+            squares[f] = 0.0;
+        }
+
+        // Forward substitution L * z = x - mu for all frames of the block.
+        for (unsigned int i = 0; i < mDimensionCount; ++i)
+        {
+            const Real* x = frames + static_cast<std::size_t>(i) * BLOCK_FRAMES;
+            const Real* cholesky = &component.cholesky[static_cast<std::size_t>(i) * mDimensionCount];
+
+            Real* z = solutions + static_cast<std::size_t>(i) * BLOCK_FRAMES;
+
+            Real mean = component.means[i];
+
+            for (unsigned int f = 0; f < BLOCK_FRAMES; ++f)
+            {
+                z[f] = x[f] - mean;
+            }
+
+            for (unsigned int j = 0; j < i; ++j)
+            {
+                const Real* zj = solutions + static_cast<std::size_t>(j) * BLOCK_FRAMES;
+
+                Real l = cholesky[j];
+
+                for (unsigned int f = 0; f < BLOCK_FRAMES; ++f)
+                {
+                    z[f] -= l * zj[f];
+                }
+            }
+
+            Real diagonalInv = component.choleskyDiagonalInv[i];
+
+            for (unsigned int f = 0; f < BLOCK_FRAMES; ++f)
+            {
+                z[f] *= diagonalInv;
+                squares[f] += z[f] * z[f];
+            }
+        }
+
+        for (unsigned int f = 0; f < frameCount; ++f)
+        {
+            output[static_cast<std::size_t>(f) * componentCount + c] = component.constant - 0.5 * squares[f];
+        }
+    }
+}
+
+void FullGMModel::InitComponents(const FrameView& samples)
+{
+    std::vector<unsigned int> indices;
+    std::vector< DynamicVector<Real> > centroids;
+    std::vector<unsigned int> sizes;
+
+    LBG lbg(GetOrder());
+    lbg.Cluster(samples, indices, centroids, sizes);
+
+    mComponents.resize(centroids.size());
+
+    Real total = 0.0f;
+
+    for (unsigned int size : sizes)
+    {
+        total += size;
+    }
+
+    std::vector<Real> covariance(static_cast<std::size_t>(mDimensionCount) * mDimensionCount);
+
+    for (unsigned int c = 0; c < mComponents.size(); ++c)
+    {
+        Component& component = mComponents[c];
+
+        component.means.assign(&centroids[c][0], &centroids[c][0] + mDimensionCount);
+        component.mixingCoefficient = sizes[c] / total;
+
+        // Diagonal covariance of all samples around the centroid, as in GMModel.
+        covariance.assign(covariance.size(), 0.0);
+
+        for (unsigned int n = 0; n < samples.GetFrameCount(); ++n)
+        {
+            const Real* sample = samples[n];
+
+            for (unsigned int d = 0; d < mDimensionCount; ++d)
+            {
+                Real difference = sample[d] - component.means[d];
+
+                covariance[static_cast<std::size_t>(d) * mDimensionCount + d] += difference * difference;
+            }
+        }
+
+        for (unsigned int d = 0; d < mDimensionCount; ++d)
+        {
+            Real& variance = covariance[static_cast<std::size_t>(d) * mDimensionCount + d];
+
+            variance = Max(variance / samples.GetFrameCount(), VARIANCE_FLOOR);
+        }
+
+        SetCovariance(component, covariance);
+    }
+}
+
+Real FullGMModel::E(const FrameView& samples, bool products, Statistics& statistics) const
+{
+    unsigned int threadCount = GetThreadCount();
+
+    if (threadCount == 0)
+    {
+        threadCount = ThreadPool::GetDefault().GetThreadCount();
+    }
+
+    // Ranges shorter than a block are not worth a thread.
+    unsigned int rangeCount = Min(threadCount, (samples.GetFrameCount() + BLOCK_FRAMES - 1) / BLOCK_FRAMES);
+    rangeCount = Max(rangeCount, 1u);
+
+    std::vector<Statistics> ranges(rangeCount);
+
+    ThreadPool::GetDefault().ParallelFor(rangeCount, [&](unsigned int r) {
+        unsigned int begin = static_cast<unsigned int>(static_cast<std::size_t>(samples.GetFrameCount()) * r / rangeCount);
+        unsigned int end = static_cast<unsigned int>(static_cast<std::size_t>(samples.GetFrameCount()) * (r + 1) / rangeCount);
+
+        AccumulateStatistics(samples, begin, end, products, ranges[r]);
+    });
+
+    // Deterministic reduction in range order.
+    statistics = ranges[0];
+
+    for (unsigned int r = 1; r < rangeCount; ++r)
+    {
+        for (std::size_t i = 0; i < statistics.probabilitySums.size(); ++i)
+        {
+            statistics.probabilitySums[i] += ranges[r].probabilitySums[i];
+        }
+
+        for (std::size_t i = 0; i < statistics.meanSums.size(); ++i)
+        {
+            statistics.meanSums[i] += ranges[r].meanSums[i];
+        }
+
+        for (std::size_t i = 0; i < statistics.productSums.size(); ++i)
+        {
+            statistics.productSums[i] += ranges[r].productSums[i];
+        }
+
+        statistics.logLikelihood += ranges[r].logLikelihood;
+    }
+
+    return statistics.logLikelihood;
+}
+
+void FullGMModel::AccumulateStatistics(const FrameView& samples, unsigned int begin, unsigned int end,
+                                       bool products, Statistics& statistics) const
+{
+    unsigned int componentCount = mComponents.size();
+
+    statistics.probabilitySums.assign(componentCount, 0.0);
+    statistics.meanSums.assign(static_cast<std::size_t>(componentCount) * mDimensionCount, 0.0);
+    statistics.productSums.assign(products ? static_cast<std::size_t>(componentCount) * mDimensionCount * mDimensionCount : 0, 0.0);
+    statistics.logLikelihood = 0.0;
+
+    std::vector<Real> block(static_cast<std::size_t>(2) * mDimensionCount * BLOCK_FRAMES);
+    std::vector<Real> logLikelihoods(static_cast<std::size_t>(BLOCK_FRAMES) * componentCount);
+
+    const Real* frames = block.data();
+    Real* weightedFrames = block.data() + static_cast<std::size_t>(mDimensionCount) * BLOCK_FRAMES;
+
+    Real posteriors[BLOCK_FRAMES];
+
+    for (unsigned int blockBegin = begin; blockBegin < end; blockBegin += BLOCK_FRAMES)
+    {
+        unsigned int blockEnd = Min(blockBegin + BLOCK_FRAMES, end);
+        unsigned int frameCount = blockEnd - blockBegin;
+
+        GetLogLikelihoods(samples, blockBegin, blockEnd, block.data(), logLikelihoods.data());
+
+        for (unsigned int f = 0; f < frameCount; ++f)
+        {
+            Real* row = &logLikelihoods[static_cast<std::size_t>(f) * componentCount];
+
+            // Using LSE for numerical stability.
+            Real probLogSumExp = MixtureKernel::LogSumExp(row, componentCount);
+
+            for (unsigned int c = 0; c < componentCount; ++c)
+            {
+                row[c] = std::exp(row[c] - probLogSumExp);
+            }
+
+            statistics.logLikelihood += probLogSumExp;
+        }
+
+        for (unsigned int c = 0; c < componentCount; ++c)
+        {
+            Real probabilitySum = 0.0;
+
+            for (unsigned int f = 0; f < BLOCK_FRAMES; ++f)
+            {
+                posteriors[f] = (f < frameCount) ? logLikelihoods[static_cast<std::size_t>(f) * componentCount + c] : 0.0;
+                probabilitySum += posteriors[f];
+            }
+
+            if (probabilitySum <= 0.0)
+            {
+                continue;
+            }
+
+            statistics.probabilitySums[c] += probabilitySum;
+
+            Real* meanSums = &statistics.meanSums[static_cast<std::size_t>(c) * mDimensionCount];
+
+            for (unsigned int d = 0; d < mDimensionCount; ++d)
+            {
+                const Real* x = frames + static_cast<std::size_t>(d) * BLOCK_FRAMES;
+                Real* wx = weightedFrames + static_cast<std::size_t>(d) * BLOCK_FRAMES;
+
+                Real sum = 0.0;
+
+                for (unsigned int f = 0; f < BLOCK_FRAMES; ++f)
+                {
+                    wx[f] = posteriors[f] * x[f];
+                    sum += wx[f];
+                }
+
+                meanSums[d] += sum;
+            }
+
+            if (!products)
+            {
+                continue;
+            }
+
+            Real* productSums = &statistics.productSums[static_cast<std::size_t>(c) * mDimensionCount * mDimensionCount];
+
+            // Lower triangle of sum(p * x * x^T) over the block.
+            for (unsigned int i = 0; i < mDimensionCount; ++i)
+            {
+                const Real* wx = weightedFrames + static_cast<std::size_t>(i) * BLOCK_FRAMES;
+
+                for (unsigned int j = 0; j <= i; ++j)
+                {
+                    const Real* x = frames + static_cast<std::size_t>(j) * BLOCK_FRAMES;
+
+                    Real sum = 0.0;
+
+                    for (unsigned int f = 0; f < BLOCK_FRAMES; ++f)
+                    {
+                        sum += wx[f] * x[f];
+                    }
+
+                    productSums[static_cast<std::size_t>(i) * mDimensionCount + j] += sum;
+                }
+            }
+        }
+    }
+}
+
+void FullGMModel::M(const Statistics& statistics, Real frameCount)
+{
+    std::vector<Real> covariance(static_cast<std::size_t>(mDimensionCount) * mDimensionCount);
+
+    for (unsigned int c = 0; c < mComponents.size(); ++c)
+    {
+        Component& component = mComponents[c];
+
+        Real n = statistics.probabilitySums[c];
+
+        component.mixingCoefficient = n / frameCount;
+
+        // A component without accumulated frames keeps its parameters and gets zero weight.
+        if (n <= 0.0f)
+        {
+            UpdateConstant(component);
+            continue;
+        }
+
+        const Real* meanSums = &statistics.meanSums[static_cast<std::size_t>(c) * mDimensionCount];
+        const Real* productSums = &statistics.productSums[static_cast<std::size_t>(c) * mDimensionCount * mDimensionCount];
+
+        for (unsigned int d = 0; d < mDimensionCount; ++d)
+        {
+            component.means[d] = meanSums[d] / n;
+        }
+
+        for (unsigned int i = 0; i < mDimensionCount; ++i)
+        {
+            for (unsigned int j = 0; j <= i; ++j)
+            {
+                std::size_t index = static_cast<std::size_t>(i) * mDimensionCount + j;
+
+                covariance[index] = productSums[index] / n - component.means[i] * component.means[j];
+            }
+
+            Real& variance = covariance[static_cast<std::size_t>(i) * mDimensionCount + i];
+
+            variance = Max(variance, VARIANCE_FLOOR);
+        }
+
+        SetCovariance(component, covariance);
+    }
+}
+
+void FullGMModel::SetCovariance(Component& component, const std::vector<Real>& covariance)
+{
+    unsigned int dimensionCount = mDimensionCount;
+
+    component.cholesky.assign(static_cast<std::size_t>(dimensionCount) * dimensionCount, 0.0);
+    component.choleskyDiagonalInv.assign(dimensionCount, 0.0);
+
+    Real jitter = 0.0;
+
+    for (unsigned int attempt = 0; attempt < CHOLESKY_ATTEMPTS; ++attempt)
+    {
+        bool positiveDefinite = true;
+
+        for (unsigned int i = 0; i < dimensionCount && positiveDefinite; ++i)
+        {
+            Real* rowI = &component.cholesky[static_cast<std::size_t>(i) * dimensionCount];
+
+            for (unsigned int j = 0; j <= i; ++j)
+            {
+                const Real* rowJ = &component.cholesky[static_cast<std::size_t>(j) * dimensionCount];
+
+                Real sum = covariance[static_cast<std::size_t>(i) * dimensionCount + j];
+
+                for (unsigned int k = 0; k < j; ++k)
+                {
+                    sum -= rowI[k] * rowJ[k];
+                }
+
+                if (i == j)
+                {
+                    sum += jitter;
+
+                    if (sum <= 0.0)
+                    {
+                        positiveDefinite = false;
+                        break;
+                    }
+
+                    rowI[i] = std::sqrt(sum);
+                }
+
+                else
+                {
+                    rowI[j] = sum / rowJ[j];
+                }
+            }
+        }
+
+        if (positiveDefinite)
+        {
+            break;
+        }
+
+        // Regularize towards a diagonal matrix until the factorization succeeds.
+        jitter = (jitter == 0.0) ? VARIANCE_FLOOR : jitter * 10.0;
+    }
+
+    component.logDeterminant = 0.0;
+
+    for (unsigned int d = 0; d < dimensionCount; ++d)
+    {
+        Real diagonal = component.cholesky[static_cast<std::size_t>(d) * dimensionCount + d];
+
+        component.choleskyDiagonalInv[d] = 1.0 / diagonal;
+        component.logDeterminant += 2.0 * std::log(diagonal);
+    }
+
+    UpdateConstant(component);
+}
+
+void FullGMModel::UpdateConstant(Component& component)
+{
+    component.constant = std::log(component.mixingCoefficient)
+                       - 0.5 * (static_cast<Real>(mDimensionCount) * std::log(2.0 * PI_F) + component.logDeterminant);
+}
@@ -1,7 +1,19 @@
 #include "GMMRecognizer.h"
 #include "GMModel.h"
+#include "FullGMModel.h"
 
 GMMRecognizer::GMMRecognizer()
+:   mCovarianceType(CovarianceType::DIAGONAL),
+    mTopComponentCount(0),
+    mAdaptationTopComponentCount(0),
+    mExpAccuracy(ExpAccuracy::EXACT),
+    mExpTolerance(0.0f),
+    mPosteriorThreshold(0.0f),
+    mBatchSize(0),
+    mBatchCount(GMModel::DEFAULT_BATCH_COUNT),
+    mStepExponent(0.7f),
+    mReducedOrder(0),
+    mReductionLossBudget(std::numeric_limits<Real>::max())
 {
 
 }
@@ -21,7 +33,467 @@ void GMMRecognizer::Test(const std::shared_ptr<SpeechData>& data, std::map<Speak
     ModelRecognizer::Test(data, results);
 }
 
+void GMMRecognizer::ClearTrainedData()
+{
+    ModelRecognizer::ClearTrainedData();
+
+    mStatistics.clear();
+    mStatisticsBackgroundModel = nullptr;
+
+    mModelBank = GMModelBank();
+    mModelBankIndices.clear();
+}
+
 std::shared_ptr<Model> GMMRecognizer::CreateModel()
 {
-    return std::make_shared<GMModel>();
+    if (mCovarianceType == CovarianceType::FULL)
+    {
+        return std::make_shared<FullGMModel>();
+    }
+
+    std::shared_ptr<GMModel> model = std::make_shared<GMModel>();
+
+    model->SetExpAccuracy(mExpAccuracy);
+    model->SetExpTolerance(mExpTolerance);
+    model->SetPosteriorThreshold(mPosteriorThreshold);
+
+    return model;
+}
+
+std::shared_ptr<Model> GMMRecognizer::CreateBackgroundModel()
+{
+    std::shared_ptr<Model> model = CreateModel();
+
+    GMModel* gmm = dynamic_cast<GMModel*>(model.get());
+
+    if (gmm != nullptr)
+    {
+        gmm->SetBatchSize(mBatchSize);
+        gmm->SetBatchCount(mBatchCount);
+        gmm->SetStepExponent(mStepExponent);
+    }
+
+    return model;
+}
+
+void GMMRecognizer::TrainBackgroundModel()
+{
+    ModelRecognizer::TrainBackgroundModel();
+
+    GMModel* background = dynamic_cast<GMModel*>(GetBackgroundModel().get());
+
+    if (mReducedOrder == 0 || background == nullptr)
+    {
+        return;
+    }
+
+    unsigned int order = background->GetOrder();
+
+    Real loss = background->Reduce(mReducedOrder, mReductionLossBudget);
+
+    std::cout << "Reduced background model from " << order << " to " << background->GetOrder()
+        << " clusters, merge cost " << loss << "." << std::endl;
+}
+
+void GMMRecognizer::AdaptModel(const std::shared_ptr<Model>& model, const SpeakerKey& speaker, const FrameView& samples)
+{
+    AdaptModels({model}, speaker, samples, {GetRelevanceFactor()});
+}
+
+void GMMRecognizer::AdaptModels(const std::vector<std::shared_ptr<Model> >& models, const SpeakerKey& speaker,
+                                const FrameView& samples, const std::vector<Real>& factors)
+{
+    std::shared_ptr<Model> backgroundModel = GetBackgroundModel();
+
+    const GMModel* background = dynamic_cast<const GMModel*>(backgroundModel.get());
+
+    // The statistics only replace a single MAP iteration.
+    if (background == nullptr || GetAdaptationIterations() != 1)
+    {
+        ModelRecognizer::AdaptModels(models, speaker, samples, factors);
+        return;
+    }
+
+    std::map<SpeakerKey, BaumWelchStatistics>::iterator it;
+
+    bool accumulate = false;
+
+    // Speakers are adapted concurrently, each speaker by a single thread.
+    {
+        std::lock_guard<std::mutex> lock(mStatisticsMutex);
+
+        // The statistics are only valid for the background model they were accumulated against.
+        if (backgroundModel != mStatisticsBackgroundModel)
+        {
+            mStatistics.clear();
+            mStatisticsBackgroundModel = backgroundModel;
+        }
+
+        it = mStatistics.find(speaker);
+
+        if (it == mStatistics.end())
+        {
+            it = mStatistics.emplace(speaker, BaumWelchStatistics()).first;
+
+            it->second.Resize(background->GetOrder(), background->GetDimensionCount());
+
+            accumulate = true;
+        }
+    }
+
+    if (accumulate)
+    {
+        background->Accumulate(samples, it->second, mAdaptationTopComponentCount);
+    }
+
+    for (unsigned int i = 0; i < models.size(); ++i)
+    {
+        GMModel* speakerModel = dynamic_cast<GMModel*>(models[i].get());
+
+        if (speakerModel == nullptr)
+        {
+            models[i]->Adapt(backgroundModel, samples, GetAdaptationIterations(), factors[i]);
+            continue;
+        }
+
+        speakerModel->Adapt(backgroundModel, it->second, factors[i]);
+    }
+}
+
+void GMMRecognizer::SetCovarianceType(CovarianceType type)
+{
+    if (type != mCovarianceType)
+    {
+        ClearTrainedData();
+    }
+
+    mCovarianceType = type;
+}
+
+CovarianceType GMMRecognizer::GetCovarianceType() const
+{
+    return mCovarianceType;
+}
+
+void GMMRecognizer::SetTopComponentCount(unsigned int count)
+{
+    // The Z-norm distributions were computed with the previous scoring.
+    if (count != mTopComponentCount)
+    {
+        Unprepare();
+    }
+
+    mTopComponentCount = count;
+}
+
+unsigned int GMMRecognizer::GetTopComponentCount() const
+{
+    return mTopComponentCount;
+}
+
+void GMMRecognizer::SetAdaptationTopComponentCount(unsigned int count)
+{
+    // The background model stays valid, only the cached statistics change.
+    if (count != mAdaptationTopComponentCount)
+    {
+        mStatistics.clear();
+        SetSpeakerModelsDirty();
+    }
+
+    mAdaptationTopComponentCount = count;
+}
+
+unsigned int GMMRecognizer::GetAdaptationTopComponentCount() const
+{
+    return mAdaptationTopComponentCount;
+}
+
+void GMMRecognizer::SetExpAccuracy(ExpAccuracy accuracy)
+{
+    if (accuracy != mExpAccuracy)
+    {
+        ClearTrainedData();
+    }
+
+    mExpAccuracy = accuracy;
+}
+
+ExpAccuracy GMMRecognizer::GetExpAccuracy() const
+{
+    return mExpAccuracy;
+}
+
+void GMMRecognizer::SetExpTolerance(Real tolerance)
+{
+    if (tolerance != mExpTolerance)
+    {
+        ClearTrainedData();
+    }
+
+    mExpTolerance = tolerance;
+}
+
+Real GMMRecognizer::GetExpTolerance() const
+{
+    return mExpTolerance;
+}
+
+void GMMRecognizer::SetPosteriorThreshold(Real threshold)
+{
+    if (threshold != mPosteriorThreshold)
+    {
+        ClearTrainedData();
+    }
+
+    mPosteriorThreshold = threshold;
+}
+
+Real GMMRecognizer::GetPosteriorThreshold() const
+{
+    return mPosteriorThreshold;
+}
+
+void GMMRecognizer::SetBatchSize(unsigned int batchSize)
+{
+    if (batchSize != mBatchSize)
+    {
+        ClearTrainedData();
+    }
+
+    mBatchSize = batchSize;
+}
+
+unsigned int GMMRecognizer::GetBatchSize() const
+{
+    return mBatchSize;
+}
+
+void GMMRecognizer::SetBatchCount(unsigned int batchCount)
+{
+    if (batchCount != mBatchCount)
+    {
+        ClearTrainedData();
+    }
+
+    mBatchCount = batchCount;
+}
+
+unsigned int GMMRecognizer::GetBatchCount() const
+{
+    return mBatchCount;
+}
+
+void GMMRecognizer::SetStepExponent(Real exponent)
+{
+    if (exponent != mStepExponent)
+    {
+        ClearTrainedData();
+    }
+
+    mStepExponent = exponent;
+}
+
+Real GMMRecognizer::GetStepExponent() const
+{
+    return mStepExponent;
+}
+
+void GMMRecognizer::SetReducedOrder(unsigned int order)
+{
+    if (order != mReducedOrder)
+    {
+        ClearTrainedData();
+    }
+
+    mReducedOrder = order;
+}
+
+unsigned int GMMRecognizer::GetReducedOrder() const
+{
+    return mReducedOrder;
+}
+
+void GMMRecognizer::SetReductionLossBudget(Real lossBudget)
+{
+    if (lossBudget != mReductionLossBudget)
+    {
+        ClearTrainedData();
+    }
+
+    mReductionLossBudget = lossBudget;
+}
+
+Real GMMRecognizer::GetReductionLossBudget() const
+{
+    return mReductionLossBudget;
+}
+
+Real GMMRecognizer::GetRatio(const std::shared_ptr<Model>& model, const FrameView& samples)
+{
+    return GetRatios(std::vector<std::shared_ptr<Model> >(1, model), samples)[0];
+}
+
+std::vector<Real> GMMRecognizer::GetRatios(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples)
+{
+    Train();
+
+    std::shared_ptr<Model> backgroundModel = GetBackgroundModel();
+
+    if (models.size() < 2 && mTopComponentCount == 0)
+    {
+        std::vector<Real> ratios;
+
+        for (const auto& model : models)
+        {
+            ratios.push_back(ModelRecognizer::GetRatio(model, samples));
+        }
+
+        return ratios;
+    }
+
+    if (!IsBackgroundModelEnabled() || backgroundModel == nullptr)
+    {
+        return GetScores(models, samples);
+    }
+
+    std::vector<Real> ratios(models.size());
+
+    if (mTopComponentCount == 0)
+    {
+        std::vector<Real> logScores = GetLogScores(models, samples);
+
+        Real backgroundLogScore = backgroundModel->GetLogScore(samples);
+
+        for (unsigned int m = 0; m < models.size(); ++m)
+        {
+            ratios[m] = logScores[m] - backgroundLogScore;
+        }
+
+        return ratios;
+    }
+
+    const GMModel* background = dynamic_cast<const GMModel*>(backgroundModel.get());
+
+    ScoringWorkspace& workspace = Model::GetThreadWorkspace();
+
+    bool selected = false;
+
+    Real backgroundLogLikelihood = 0.0f;
+
+    for (unsigned int m = 0; m < models.size(); ++m)
+    {
+        if (!IsTopComponentScoringEnabled(models[m]))
+        {
+            ratios[m] = ModelRecognizer::GetRatio(models[m], samples);
+            continue;
+        }
+
+        // The background model is evaluated once for all models.
+        if (!selected)
+        {
+            backgroundLogLikelihood = background->SelectTopComponents(samples, mTopComponentCount, workspace.components, workspace);
+            selected = true;
+        }
+
+        const GMModel* speaker = static_cast<const GMModel*>(models[m].get());
+
+        ratios[m] = speaker->GetLogLikelihood(samples, workspace.components, mTopComponentCount) - backgroundLogLikelihood;
+    }
+
+    return ratios;
+}
+
+std::vector<Real> GMMRecognizer::GetScores(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples)
+{
+    std::vector<Real> scores = GetLogScores(models, samples);
+
+    // GMModel::GetScore() is the exponent of GMModel::GetLogScore().
+    for (Real& score : scores)
+    {
+        score = std::exp(score);
+    }
+
+    return scores;
+}
+
+std::vector<Real> GMMRecognizer::GetLogScores(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples)
+{
+    if (models.size() < 2 || mModelBankIndices.empty())
+    {
+        return ModelRecognizer::GetLogScores(models, samples);
+    }
+
+    std::vector<unsigned int> indices;
+
+    for (const auto& model : models)
+    {
+        auto it = mModelBankIndices.find(model.get());
+
+        if (it == mModelBankIndices.end())
+        {
+            return ModelRecognizer::GetLogScores(models, samples);
+        }
+
+        indices.push_back(it->second);
+    }
+
+    std::vector<Real> logScores;
+
+    mModelBank.GetLogLikelihoods(samples, indices, logScores, Model::GetThreadWorkspace());
+
+    return logScores;
+}
+
+void GMMRecognizer::PrepareModels()
+{
+    ModelRecognizer::PrepareModels();
+
+    mModelBank = GMModelBank();
+    mModelBankIndices.clear();
+
+    std::vector<const GMModel*> gmms;
+
+    for (const auto& model : GetSpeakerModels())
+    {
+        const GMModel* gmm = dynamic_cast<const GMModel*>(model.second.get());
+
+        if (gmm == nullptr)
+        {
+            return;
+        }
+
+        gmms.push_back(gmm);
+    }
+
+    if (gmms.size() < 2 || !mModelBank.Build(gmms))
+    {
+        return;
+    }
+
+    for (unsigned int m = 0; m < gmms.size(); ++m)
+    {
+        mModelBankIndices[gmms[m]] = m;
+    }
+}
+
+void GMMRecognizer::Unprepare()
+{
+    ModelRecognizer::Unprepare();
+
+    mModelBank = GMModelBank();
+    mModelBankIndices.clear();
+}
+
+bool GMMRecognizer::IsTopComponentScoringEnabled(const std::shared_ptr<Model>& model)
+{
+    if (mTopComponentCount == 0 || !IsBackgroundModelEnabled() || !IsAdaptationEnabled())
+    {
+        return false;
+    }
+
+    const GMModel* background = dynamic_cast<const GMModel*>(GetBackgroundModel().get());
+    const GMModel* speaker = dynamic_cast<const GMModel*>(model.get());
+
+    // The components correspond only if the speaker model was adapted from the background model.
+    return background != nullptr && speaker != nullptr && speaker->GetOrder() == background->GetOrder();
 }
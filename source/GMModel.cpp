@@ -1,9 +1,15 @@
 #include "GMModel.h"
 #include "LBG.h"
+#include "ThreadPool.h"
 
 GMModel::GMModel()
 : mTrainingIterations(75),
-  mEta(0.001f)
+  mEta(0.001f),
+  mPosteriorThreshold(0.0f),
+  mBatchSize(0),
+  mBatchCount(DEFAULT_BATCH_COUNT),
+  mStepOffset(1.0f),
+  mStepExponent(0.7f)
 {
 
 }
@@ -21,18 +27,24 @@ void GMModel::Init()
     }
 }
 
-void GMModel::Train(const std::vector< DynamicVector<Real> >& samples, unsigned int iterations)
+void GMModel::Train(const FrameView& samples, unsigned int iterations)
 {
     SetTrainingIterations(iterations);
 
     Init();
 
+    if (mBatchSize > 0)
+    {
+        MiniBatchEM(samples);
+        return;
+    }
+
     InitClusters(samples);
 
     EM(samples);
 }
 
-void GMModel::Adapt(const std::shared_ptr<Model>& other, const std::vector< DynamicVector<Real> >& samples,
+void GMModel::Adapt(const std::shared_ptr<Model>& other, const FrameView& samples,
                     unsigned int iterations, Real relevanceFactor)
 {
     const GMModel* model = dynamic_cast<GMModel*>(other.get());
@@ -43,149 +55,403 @@ void GMModel::Adapt(const std::shared_ptr<Model>& other, const std::vector< Dyna
         return;
     }
 
-    SetOrder(other->GetOrder());
-    Init();
+    CopyClusters(*model);
 
-    for (unsigned int c = 0; c < GetOrder(); c++)
+    Real logLikelihood = 0.0f;
+
+    unsigned int dimensionCount = GetDimensionCount();
+
+    Statistics statistics;
+
+    for (unsigned int e = 0; e < iterations; ++e)
     {
-        mClusters[c].means = model->mClusters[c].means;
-        mClusters[c].variances = model->mClusters[c].variances;
-        mClusters[c].mixingCoefficient = model->mClusters[c].mixingCoefficient;
+        Real newLogLikelihood = E(samples, false, statistics);
+
+        for (unsigned int c = 0; c < mClusters.size(); ++c)
+        {
+            Cluster& cluster = mClusters[c];
+
+            Real n = statistics.probabilitySums[c];
+            
+            // A cluster without accumulated frames keeps its mean.
+            if (n <= 0.0f)
+            {
+                UpdatePDF(cluster);
+                continue;
+            }
+
+            Real adaptionCoeff = n / (n + relevanceFactor);
+
+            const Real* meanSums = &statistics.meanSums[static_cast<std::size_t>(c) * dimensionCount];
+
+            for (unsigned int d = 0; d < dimensionCount; ++d)
+            {
+                cluster.means[d] = adaptionCoeff * (meanSums[d] / n) + (1.0f - adaptionCoeff) * cluster.means[d];
+            }
+
+            UpdatePDF(cluster);
+        }
+
+        UpdateKernel();
 
-        mClusters[c].meansTmp = model->mClusters[c].meansTmp;
-        mClusters[c].variancesTmp = model->mClusters[c].variancesTmp;
-        mClusters[c].variancesInv = model->mClusters[c].variancesInv;
+        if (std::abs(logLikelihood - newLogLikelihood) / samples.GetFrameCount() < mEta)
+        {
+            break;
+        }
+
+        logLikelihood = newLogLikelihood;
+
+        PrintIteration();
     }
 
-    for (auto& cluster : mClusters)
+    EndIterations();
+}
+
+void GMModel::Adapt(const std::shared_ptr<Model>& other, const BaumWelchStatistics& statistics, Real relevanceFactor)
+{
+    const GMModel* model = dynamic_cast<GMModel*>(other.get());
+
+    if (model == nullptr)
     {
-        UpdatePDF(cluster);
+        std::cout << "Not GMModel." << std::endl;
+        return;
     }
 
-    Real logLikelihood = 0.0f;
-    Real newLogLikelihood = 0.0f;
+    if (statistics.GetComponentCount() != model->mClusters.size() ||
+        statistics.GetDimensionCount() != model->GetDimensionCount())
+    {
+        std::cout << "Statistics do not match the model." << std::endl;
+        return;
+    }
 
-    for (unsigned int e = 0; e < iterations; ++e)
+    CopyClusters(*model);
+
+    for (unsigned int c = 0; c < mClusters.size(); ++c)
     {
-        for (auto& cluster : mClusters)
+        Cluster& cluster = mClusters[c];
+
+        Real n = statistics.GetZerothOrder(c);
+
+        // A cluster without accumulated frames keeps its mean.
+        if (n <= 0.0f)
         {
-            cluster.membershipProbabilitySum = 0.0f;
-            cluster.meansTmp.Assign(0.0f);
+            continue;
         }
 
-        Real newLogLikelihood = 0.0f;
+        Real adaptionCoeff = n / (n + relevanceFactor);
+
+        const Real* firstOrder = statistics.GetFirstOrder(c);
 
-        for (const auto& sample : samples)
+        for (unsigned int d = 0; d < cluster.means.GetSize(); ++d)
         {
-            // Using LSE for numerical stability.
-            Real probMax = std::numeric_limits<Real>::min();
-            Real probSumExp = 0.0f;
-            Real probLogSumExp = 0.0f;
+            cluster.means[d] = adaptionCoeff * (firstOrder[d] / n) + (1.0f - adaptionCoeff) * cluster.means[d];
+        }
 
-            for (auto& cluster : mClusters)
-            {
-                cluster.membershipProbability = GetLogLikelihood(sample, cluster);
+        UpdatePDF(cluster);
+    }
 
-                if (cluster.membershipProbability > probMax)
-                    probMax = cluster.membershipProbability;
-            }
+    UpdateKernel();
+}
+
+void GMModel::Accumulate(const FrameView& samples, BaumWelchStatistics& statistics, unsigned int topCount) const
+{
+    unsigned int rangeCount = GetRangeCount(samples.GetFrameCount());
+
+    std::size_t mismatches = 0;
+
+    if (rangeCount == 1)
+    {
+        AccumulateFrames(samples, statistics, topCount, mismatches);
+        MixtureKernel::ReportMismatches(mismatches);
+        return;
+    }
+
+    std::vector<BaumWelchStatistics> ranges(rangeCount);
+    std::vector<std::size_t> rangeMismatches(rangeCount, 0);
+
+    ThreadPool::GetDefault().ParallelFor(rangeCount, [&](unsigned int r) {
+        unsigned int begin = static_cast<unsigned int>(static_cast<std::size_t>(samples.GetFrameCount()) * r / rangeCount);
+        unsigned int end = static_cast<unsigned int>(static_cast<std::size_t>(samples.GetFrameCount()) * (r + 1) / rangeCount);
+
+        ranges[r].Resize(statistics.GetComponentCount(), statistics.GetDimensionCount(), statistics.HasSecondOrder());
+
+        AccumulateFrames(samples.GetFrames(begin, end), ranges[r], topCount, rangeMismatches[r]);
+    });
+
+    // Deterministic reduction in range order.
+    for (unsigned int r = 0; r < rangeCount; ++r)
+    {
+        statistics.Add(ranges[r]);
+        mismatches += rangeMismatches[r];
+    }
+
+    MixtureKernel::ReportMismatches(mismatches);
+}
+
+void GMModel::AccumulateFrames(const FrameView& samples, BaumWelchStatistics& statistics, unsigned int topCount,
+                               std::size_t& mismatches) const
+{
+    unsigned int clusterCount = mClusters.size();
+
+    assert(statistics.GetComponentCount() == clusterCount);
+    assert(statistics.GetDimensionCount() == samples.GetDimensionCount());
 
-            for (const auto& cluster : mClusters)
-                probSumExp += std::exp(cluster.membershipProbability - probMax);
+    std::vector<Real> logLikelihoods;
+    std::vector<Real> posteriors(clusterCount);
+    std::vector<unsigned int> components(clusterCount);
+
+    // Top-C: posteriors are normalized over the best components of each frame.
+    if (topCount > 0 && topCount < clusterCount)
+    {
+        std::vector<unsigned int> top;
+        std::vector<Real> values(topCount);
 
-            probLogSumExp = probMax + std::log(probSumExp);
+        mKernel.SelectTopComponents(samples, topCount, top, logLikelihoods, mismatches);
 
-            for (auto& cluster : mClusters)
+        for (unsigned int n = 0; n < samples.GetFrameCount(); ++n)
+        {
+            const Real* sample = samples[n];
+            const unsigned int* frameTop = &top[static_cast<std::size_t>(n) * topCount];
+
+            for (unsigned int i = 0; i < topCount; ++i)
             {
-                // Calculate the final membership probability.
-                cluster.membershipProbability = std::exp(cluster.membershipProbability - probLogSumExp);
+                values[i] = mKernel.GetLogLikelihood(sample, frameTop[i]);
+            }
 
-                // Calculate the final sum of membership probabilities.
-                cluster.membershipProbabilitySum += cluster.membershipProbability;
+            Real probLogSumExp;
 
-                for (unsigned int d = 0; d < cluster.means.GetSize(); ++d)
-                {
-                    // Mean sum(p*x)
-                    cluster.meansTmp[d] += sample[d] * cluster.membershipProbability;
-                }
+            unsigned int selected = mKernel.GetPosteriors(values.data(), topCount, mPosteriorThreshold,
+                                                          posteriors.data(), components.data(), probLogSumExp,
+                                                          mismatches);
+
+            for (unsigned int i = 0; i < selected; ++i)
+            {
+                statistics.Accumulate(sample, frameTop[components[i]], posteriors[i]);
             }
 
-            newLogLikelihood += probLogSumExp;
+            statistics.AddFrame(probLogSumExp);
         }
-        
-        for (auto& cluster : mClusters)
+
+        return;
+    }
+
+    logLikelihoods.resize(static_cast<std::size_t>(MixtureKernel::BUFFER_FRAMES) * clusterCount);
+
+    for (unsigned int begin = 0; begin < samples.GetFrameCount(); begin += MixtureKernel::BUFFER_FRAMES)
+    {
+        unsigned int end = Min(begin + MixtureKernel::BUFFER_FRAMES, samples.GetFrameCount());
+
+        mKernel.GetLogLikelihoods(samples, begin, end, logLikelihoods.data());
+
+        for (unsigned int n = begin; n < end; ++n)
         {
-            Real n = cluster.membershipProbabilitySum;
-            
-            Real adaptionCoeff = n / (n + relevanceFactor);
+            const Real* sample = samples[n];
+            const Real* row = &logLikelihoods[static_cast<std::size_t>(n - begin) * clusterCount];
+
+            Real probLogSumExp;
 
-            for (unsigned int d = 0; d < mClusters[0].means.GetSize(); ++d)
+            unsigned int selected = mKernel.GetPosteriors(row, clusterCount, mPosteriorThreshold,
+                                                          posteriors.data(), components.data(), probLogSumExp,
+                                                          mismatches);
+
+            for (unsigned int i = 0; i < selected; ++i)
             {
-                cluster.means[d] = adaptionCoeff * (cluster.meansTmp[d] / n) + (1.0f - adaptionCoeff) * cluster.means[d];
+                statistics.Accumulate(sample, components[i], posteriors[i]);
             }
 
-            UpdatePDF(cluster);
+            statistics.AddFrame(probLogSumExp);
         }
+    }
+}
 
-        if (std::abs(logLikelihood - newLogLikelihood) / samples.size() < mEta)
+Real GMModel::Reduce(unsigned int order, Real lossBudget, Real minimumWeight)
+{
+    order = Max(order, 1u);
+
+    // Drop negligible clusters, but never all of them.
+    if (minimumWeight > 0.0f)
+    {
+        std::vector<Cluster> clusters;
+
+        Real weightSum = 0.0f;
+
+        for (const auto& cluster : mClusters)
         {
-            break;
+            if (cluster.mixingCoefficient >= minimumWeight)
+            {
+                clusters.push_back(cluster);
+                weightSum += cluster.mixingCoefficient;
+            }
         }
 
-        logLikelihood = newLogLikelihood;
+        if (!clusters.empty() && clusters.size() < mClusters.size())
+        {
+            for (auto& cluster : clusters)
+            {
+                cluster.mixingCoefficient /= weightSum;
+            }
 
-        std::cout << ".";
+            mClusters.swap(clusters);
+        }
     }
 
-    std::cout << std::endl;
-}
+    unsigned int clusterCount = mClusters.size();
 
-Real GMModel::GetLogLikelihood(const std::vector< DynamicVector<Real> >& samples) const
-{
-    if (samples.size() == 0)
+    std::vector<Real> logDeterminants(clusterCount);
+
+    for (unsigned int c = 0; c < clusterCount; ++c)
     {
-        return 0.0f;
+        logDeterminants[c] = GetLogDeterminant(mClusters[c]);
+    }
+
+    // The costs of the pairs i < j, updated for the merged cluster only.
+    std::vector<Real> costs(static_cast<std::size_t>(clusterCount) * clusterCount, 0.0f);
+
+    for (unsigned int i = 0; i < clusterCount; ++i)
+    {
+        for (unsigned int j = i + 1; j < clusterCount; ++j)
+        {
+            costs[static_cast<std::size_t>(i) * clusterCount + j] = GetMergeCost(mClusters[i], mClusters[j], logDeterminants[i], logDeterminants[j]);
+        }
     }
 
-    Real result = 0.0f;
-    Real invN = 1.0f / static_cast<Real>(samples.size());
+    std::vector<bool> merged(clusterCount, false);
+
+    unsigned int activeCount = clusterCount;
+
+    Real loss = 0.0f;
 
-    for (const auto& sample : samples)
+    while (activeCount > order)
     {
-        // Using LSE for numerical stability.
-        Real probMax = std::numeric_limits<Real>::min();
-        Real probSumExp = 0.0f;
-        Real probLogSumExp = 0.0f;
+        unsigned int bestI = 0;
+        unsigned int bestJ = 0;
 
-        for (auto& cluster : mClusters)
+        Real bestCost = std::numeric_limits<Real>::max();
+
+        for (unsigned int i = 0; i < clusterCount; ++i)
         {
-            // TODO get rid of this assignment. For now this is "ok" though as long
-            // as this function is called outside.
-            cluster.membershipProbability = GetLogLikelihood(sample, cluster);
+            if (merged[i])
+            {
+                continue;
+            }
 
-            if (cluster.membershipProbability > probMax)
-                probMax = cluster.membershipProbability;
+            const Real* row = &costs[static_cast<std::size_t>(i) * clusterCount];
+
+            for (unsigned int j = i + 1; j < clusterCount; ++j)
+            {
+                if (!merged[j] && row[j] < bestCost)
+                {
+                    bestCost = row[j];
+                    bestI = i;
+                    bestJ = j;
+                }
+            }
         }
 
-        for (const auto& cluster : mClusters)
-            probSumExp += std::exp(cluster.membershipProbability - probMax);
+        if (loss + bestCost > lossBudget)
+        {
+            break;
+        }
+
+        MergeClusters(mClusters[bestI], mClusters[bestJ]);
+
+        merged[bestJ] = true;
+        --activeCount;
+
+        loss += bestCost;
+
+        logDeterminants[bestI] = GetLogDeterminant(mClusters[bestI]);
+
+        for (unsigned int k = 0; k < clusterCount; ++k)
+        {
+            if (k == bestI || merged[k])
+            {
+                continue;
+            }
+
+            unsigned int i = Min(k, bestI);
+            unsigned int j = Max(k, bestI);
+
+            costs[static_cast<std::size_t>(i) * clusterCount + j] = GetMergeCost(mClusters[i], mClusters[j], logDeterminants[i], logDeterminants[j]);
+        }
+    }
 
-        probLogSumExp = probMax + std::log(probSumExp);
+    std::vector<Cluster> clusters;
 
-        result += probLogSumExp * invN;
+    for (unsigned int c = 0; c < clusterCount; ++c)
+    {
+        if (!merged[c])
+        {
+            clusters.push_back(mClusters[c]);
+        }
     }
 
+    mClusters.swap(clusters);
+
+    SetOrder(mClusters.size());
+
+    for (auto& cluster : mClusters)
+    {
+        UpdatePDF(cluster);
+    }
+
+    UpdateKernel();
+
+    return loss;
+}
+
+Real GMModel::GetLogLikelihood(const FrameView& samples) const
+{
+    return GetLogLikelihood(samples, GetThreadWorkspace());
+}
+
+Real GMModel::GetLogLikelihood(const FrameView& samples, ScoringWorkspace& workspace) const
+{
+    std::size_t mismatches = 0;
+
+    Real result = mKernel.GetLogLikelihood(samples, workspace.values, mismatches);
+
+    MixtureKernel::ReportMismatches(mismatches);
+
+    return result;
+}
+
+Real GMModel::SelectTopComponents(const FrameView& samples, unsigned int topCount,
+                                  std::vector<unsigned int>& components, ScoringWorkspace& workspace) const
+{
+    std::size_t mismatches = 0;
+
+    Real result = mKernel.SelectTopComponents(samples, topCount, components, workspace.values, mismatches);
+
+    MixtureKernel::ReportMismatches(mismatches);
+
     return result;
 }
 
-Real GMModel::GetScore(const std::vector< DynamicVector<Real> >& samples) const
+Real GMModel::GetLogLikelihood(const FrameView& samples, const std::vector<unsigned int>& components, unsigned int topCount) const
+{
+    std::size_t mismatches = 0;
+
+    Real result = mKernel.GetLogLikelihood(samples, components, topCount, mismatches);
+
+    MixtureKernel::ReportMismatches(mismatches);
+
+    return result;
+}
+
+Real GMModel::GetScore(const FrameView& samples, ScoringWorkspace& workspace) const
+{
+    return std::exp(GetLogScore(samples, workspace));
+}
+
+Real GMModel::GetLogScore(const FrameView& samples, ScoringWorkspace& workspace) const
 {
-    return std::exp(GetLogScore(samples));
+    return GetLogLikelihood(samples, workspace);
 }
 
-Real GMModel::GetLogScore(const std::vector< DynamicVector<Real> >& samples) const
+const std::vector<GMModel::Cluster>& GMModel::GetClusters() const
 {
-    return GetLogLikelihood(samples);
+    return mClusters;
 }
 
 unsigned int GMModel::GetDimensionCount() const
@@ -198,17 +464,15 @@ unsigned int GMModel::GetDimensionCount() const
     return mClusters.begin()->means.GetSize();
 }
 
-void GMModel::InitClusters(const std::vector< DynamicVector<Real> >& samples)
+void GMModel::InitClusters(const FrameView& samples)
 {
     // Create the initial centroid by averaging sample data.
 
     for (auto& cluster : mClusters)
     {
-        cluster.means.Resize(samples[0].GetSize());
-        cluster.variances.Resize(samples[0].GetSize());
-        cluster.meansTmp.Resize(samples[0].GetSize());
-        cluster.variancesTmp.Resize(samples[0].GetSize());
-        cluster.variancesInv.Resize(samples[0].GetSize());
+        cluster.means.Resize(samples.GetDimensionCount());
+        cluster.variances.Resize(samples.GetDimensionCount());
+        cluster.variancesInv.Resize(samples.GetDimensionCount());
     }
 
     std::vector<unsigned int> indices;
@@ -241,9 +505,11 @@ void GMModel::InitClusters(const std::vector< DynamicVector<Real> >& samples)
     {
         for (unsigned int d = 0; d < mClusters[0].means.GetSize(); ++d)
         {
-            for (const auto& sample : samples)
+            for (unsigned int n = 0; n < samples.GetFrameCount(); ++n)
             {
-                cluster.variances[d] += (cluster.means[d] - sample[d]) * (cluster.means[d] - sample[d]) / samples.size();
+                const Real* sample = samples[n];
+
+                cluster.variances[d] += (cluster.means[d] - sample[d]) * (cluster.means[d] - sample[d]) / samples.GetFrameCount();
             }
         }
     }
@@ -269,32 +535,216 @@ Real GMModel::GetTrainingThreshold() const
     return mEta;
 }
 
-void GMModel::EM(const std::vector< DynamicVector<Real> >& samples)
+void GMModel::SetExpAccuracy(ExpAccuracy accuracy)
+{
+    mKernel.SetExpAccuracy(accuracy);
+}
+
+ExpAccuracy GMModel::GetExpAccuracy() const
+{
+    return mKernel.GetExpAccuracy();
+}
+
+void GMModel::SetExpTolerance(Real tolerance)
+{
+    mKernel.SetExpTolerance(tolerance);
+}
+
+Real GMModel::GetExpTolerance() const
+{
+    return mKernel.GetExpTolerance();
+}
+
+void GMModel::SetPosteriorThreshold(Real threshold)
+{
+    mPosteriorThreshold = threshold;
+}
+
+Real GMModel::GetPosteriorThreshold() const
+{
+    return mPosteriorThreshold;
+}
+
+void GMModel::SetBatchSize(unsigned int batchSize)
+{
+    mBatchSize = batchSize;
+}
+
+unsigned int GMModel::GetBatchSize() const
+{
+    return mBatchSize;
+}
+
+void GMModel::SetBatchCount(unsigned int batchCount)
+{
+    mBatchCount = batchCount;
+}
+
+unsigned int GMModel::GetBatchCount() const
+{
+    return mBatchCount;
+}
+
+void GMModel::SetStepOffset(Real offset)
+{
+    mStepOffset = offset;
+}
+
+Real GMModel::GetStepOffset() const
+{
+    return mStepOffset;
+}
+
+void GMModel::SetStepExponent(Real exponent)
+{
+    mStepExponent = exponent;
+}
+
+Real GMModel::GetStepExponent() const
+{
+    return mStepExponent;
+}
+
+void GMModel::EM(const FrameView& samples)
 {
     for (auto& cluster : mClusters)
     {
         UpdatePDF(cluster);
     }
 
+    UpdateKernel();
+
     Real logLikelihood = 0.0f;
     Real newLogLikelihood = 0.0f;
 
+    Statistics statistics;
+
     for (unsigned int e = 0; e < mTrainingIterations; ++e)
     {
         //std::cout << "Iteration:" << e << std::endl;
 
-        for (auto& cluster : mClusters)
+        newLogLikelihood = E(samples, true, statistics);
+
+        M(samples.GetFrameCount(), statistics);
+        
+        if (std::abs(logLikelihood - newLogLikelihood) < mEta)
+        {
+            break;
+        }
+
+        logLikelihood = newLogLikelihood;
+
+        PrintIteration();
+    }
+
+    EndIterations();
+}
+
+void GMModel::MiniBatchEM(const FrameView& samples)
+{
+    unsigned int frameCount = samples.GetFrameCount();
+    unsigned int dimensionCount = samples.GetDimensionCount();
+
+    if (frameCount == 0)
+    {
+        return;
+    }
+
+    unsigned int batchSize = Min(mBatchSize, frameCount);
+    unsigned int batchCount = (mBatchCount > 0) ? mBatchCount : (frameCount + batchSize - 1) / batchSize;
+
+    // A fixed seed keeps training reproducible.
+    std::mt19937 generator;
+
+    std::vector<unsigned int> order(frameCount);
+
+    for (unsigned int n = 0; n < frameCount; ++n)
+    {
+        order[n] = n;
+    }
+
+    std::shuffle(order.begin(), order.end(), generator);
+
+    FrameMatrix batch(dimensionCount);
+
+    // Initialize from the frames of the first batches.
+    unsigned int initialBatchCount = Min(batchCount, INITIAL_BATCH_COUNT);
+    unsigned int initialCount = static_cast<unsigned int>(Min<std::size_t>(static_cast<std::size_t>(batchSize) * initialBatchCount, frameCount));
+
+    batch.Reserve(initialCount);
+
+    for (unsigned int n = 0; n < initialCount; ++n)
+    {
+        batch.AddFrame(samples[order[n]]);
+    }
+
+    InitClusters(batch);
+
+    for (auto& cluster : mClusters)
+    {
+        UpdatePDF(cluster);
+    }
+
+    UpdateKernel();
+
+    // Running statistics normalized by the number of frames.
+    Statistics running;
+
+    running.probabilitySums.assign(mClusters.size(), 0.0);
+    running.meanSums.assign(mClusters.size() * dimensionCount, 0.0);
+    running.squareSums.assign(mClusters.size() * dimensionCount, 0.0);
+
+    Statistics statistics;
+
+    unsigned int position = 0;
+    unsigned int step = 0;
+
+    Real logLikelihood = 0.0f;
+
+    for (unsigned int e = 0; e < mTrainingIterations; ++e)
+    {
+        Real newLogLikelihood = 0.0f;
+        unsigned int iterationFrameCount = 0;
+
+        for (unsigned int b = 0; b < batchCount; ++b, ++step)
         {
-            cluster.membershipProbabilitySum = 0.0f;
+            batch.Clear();
+
+            for (unsigned int n = 0; n < batchSize; ++n)
+            {
+                // Reshuffle after each pass over the frames.
+                if (position == frameCount)
+                {
+                    std::shuffle(order.begin(), order.end(), generator);
+                    position = 0;
+                }
+
+                batch.AddFrame(samples[order[position++]]);
+            }
+
+            newLogLikelihood += E(batch, true, statistics);
+            iterationFrameCount += batchSize;
+
+            Real stepSize = std::pow(static_cast<Real>(step) + mStepOffset, -mStepExponent);
+            Real batchStepSize = stepSize / static_cast<Real>(batchSize);
+
+            for (unsigned int c = 0; c < mClusters.size(); ++c)
+            {
+                running.probabilitySums[c] = (1.0f - stepSize) * running.probabilitySums[c] + batchStepSize * statistics.probabilitySums[c];
+            }
+
+            for (std::size_t i = 0; i < running.meanSums.size(); ++i)
+            {
+                running.meanSums[i] = (1.0f - stepSize) * running.meanSums[i] + batchStepSize * statistics.meanSums[i];
+                running.squareSums[i] = (1.0f - stepSize) * running.squareSums[i] + batchStepSize * statistics.squareSums[i];
+            }
 
-            cluster.meansTmp.Assign(0.0f);
-            cluster.variancesTmp.Assign(0.0f);
+            M(1.0f, running);
         }
 
-        newLogLikelihood = E(samples);
+        // The batches are scored before their M-step, so this lags the model slightly.
+        newLogLikelihood /= static_cast<Real>(iterationFrameCount);
 
-        M(samples);
-        
         if (std::abs(logLikelihood - newLogLikelihood) < mEta)
         {
             break;
@@ -302,99 +752,271 @@ void GMModel::EM(const std::vector< DynamicVector<Real> >& samples)
 
         logLikelihood = newLogLikelihood;
 
-        std::cout << ".";
+        PrintIteration();
     }
 
-    std::cout << std::endl;
+    EndIterations();
 }
 
-Real GMModel::E(const std::vector< DynamicVector<Real> >& samples)
+Real GMModel::E(const FrameView& samples, bool squares, Statistics& statistics) const
 {
-    Real newLogLikelihood = 0.0f;
+    unsigned int rangeCount = GetRangeCount(samples.GetFrameCount());
+
+    std::vector<Statistics> ranges(rangeCount);
 
-    for (const auto& sample : samples)
+    ThreadPool::GetDefault().ParallelFor(rangeCount, [&](unsigned int r) {
+        unsigned int begin = static_cast<unsigned int>(static_cast<std::size_t>(samples.GetFrameCount()) * r / rangeCount);
+        unsigned int end = static_cast<unsigned int>(static_cast<std::size_t>(samples.GetFrameCount()) * (r + 1) / rangeCount);
+
+        AccumulateStatistics(samples, begin, end, squares, ranges[r]);
+    });
+
+    unsigned int clusterCount = mClusters.size();
+    unsigned int dimensionCount = GetDimensionCount();
+
+    statistics.probabilitySums.assign(clusterCount, 0.0);
+    statistics.meanSums.assign(static_cast<std::size_t>(clusterCount) * dimensionCount, 0.0);
+    statistics.squareSums.assign(squares ? static_cast<std::size_t>(clusterCount) * dimensionCount : 0, 0.0);
+    statistics.logLikelihood = 0.0;
+    statistics.expMismatches = 0;
+
+    // Deterministic reduction in range order.
+    for (const auto& range : ranges)
     {
-        // Using LSE for numerical stability.
-        Real probMax = std::numeric_limits<Real>::min();
-        Real probSumExp = 0.0f;
-        Real probLogSumExp = 0.0f;
+        for (unsigned int c = 0; c < clusterCount; ++c)
+        {
+            statistics.probabilitySums[c] += range.probabilitySums[c];
+        }
 
-        for (auto& cluster : mClusters)
+        for (std::size_t i = 0; i < statistics.meanSums.size(); ++i)
         {
-            cluster.membershipProbability = GetLogLikelihood(sample, cluster);
+            statistics.meanSums[i] += range.meanSums[i];
+        }
 
-            if (cluster.membershipProbability > probMax)
-                probMax = cluster.membershipProbability;
+        for (std::size_t i = 0; i < statistics.squareSums.size(); ++i)
+        {
+            statistics.squareSums[i] += range.squareSums[i];
         }
 
-        for (const auto& cluster : mClusters)
-            probSumExp += std::exp(cluster.membershipProbability - probMax);
+        statistics.logLikelihood += range.logLikelihood;
+        statistics.expMismatches += range.expMismatches;
+    }
+
+    MixtureKernel::ReportMismatches(statistics.expMismatches);
+
+    return statistics.logLikelihood;
+}
+
+unsigned int GMModel::GetRangeCount(unsigned int frameCount) const
+{
+    unsigned int threadCount = GetThreadCount();
+
+    if (threadCount == 0)
+    {
+        threadCount = ThreadPool::GetDefault().GetThreadCount();
+    }
+
+    // Ranges shorter than a kernel buffer are not worth a thread.
+    unsigned int rangeCount = Min(threadCount, (frameCount + MixtureKernel::BUFFER_FRAMES - 1) / MixtureKernel::BUFFER_FRAMES);
 
-        probLogSumExp = probMax + std::log(probSumExp);
+    return Max(rangeCount, 1u);
+}
+
+void GMModel::AccumulateStatistics(const FrameView& samples, unsigned int begin, unsigned int end,
+                                   bool squares, Statistics& statistics) const
+{
+    unsigned int clusterCount = mClusters.size();
+    unsigned int dimensionCount = GetDimensionCount();
+
+    statistics.probabilitySums.assign(clusterCount, 0.0);
+    statistics.meanSums.assign(static_cast<std::size_t>(clusterCount) * dimensionCount, 0.0);
+    statistics.squareSums.assign(squares ? static_cast<std::size_t>(clusterCount) * dimensionCount : 0, 0.0);
+    statistics.logLikelihood = 0.0;
+    statistics.expMismatches = 0;
 
-        for (auto& cluster : mClusters)
+    std::vector<Real> logLikelihoods(static_cast<std::size_t>(MixtureKernel::BUFFER_FRAMES) * clusterCount);
+
+    std::vector<Real> posteriors(clusterCount);
+    std::vector<unsigned int> components(clusterCount);
+
+    for (unsigned int bufferBegin = begin; bufferBegin < end; bufferBegin += MixtureKernel::BUFFER_FRAMES)
+    {
+        unsigned int bufferEnd = Min(bufferBegin + MixtureKernel::BUFFER_FRAMES, end);
+
+        mKernel.GetLogLikelihoods(samples, bufferBegin, bufferEnd, logLikelihoods.data());
+
+        for (unsigned int n = bufferBegin; n < bufferEnd; ++n)
         {
-            // Calculate the final membership probability.
-            cluster.membershipProbability = std::exp(cluster.membershipProbability - probLogSumExp);
+            const Real* sample = samples[n];
+            const Real* row = &logLikelihoods[static_cast<std::size_t>(n - bufferBegin) * clusterCount];
+
+            // Using LSE for numerical stability.
+            Real probLogSumExp;
 
-            // Calculate the final sum of membership probabilities.
-            cluster.membershipProbabilitySum += cluster.membershipProbability;
+            unsigned int selected = mKernel.GetPosteriors(row, clusterCount, mPosteriorThreshold,
+                                                          posteriors.data(), components.data(), probLogSumExp,
+                                                          statistics.expMismatches);
 
-            for (unsigned int d = 0; d < cluster.means.GetSize(); ++d)
+            for (unsigned int i = 0; i < selected; ++i)
             {
-                // Mean sum(p*x)
-                 cluster.meansTmp[d] += sample[d] * cluster.membershipProbability;
+                unsigned int c = components[i];
+
+                // Calculate the final membership probability.
+                Real probability = posteriors[i];
 
-                // Variance sum(p*x^2) (- mu^2)
-                cluster.variancesTmp[d] += sample[d] * sample[d] * cluster.membershipProbability;
+                Real* meanSums = &statistics.meanSums[static_cast<std::size_t>(c) * dimensionCount];
+
+                // Calculate the final sum of membership probabilities.
+                statistics.probabilitySums[c] += probability;
+
+                for (unsigned int d = 0; d < dimensionCount; ++d)
+                {
+                    // Mean sum(p*x)
+                    meanSums[d] += sample[d] * probability;
+                }
+
+                if (!squares)
+                {
+                    continue;
+                }
+
+                Real* squareSums = &statistics.squareSums[static_cast<std::size_t>(c) * dimensionCount];
+
+                for (unsigned int d = 0; d < dimensionCount; ++d)
+                {
+                    // Variance sum(p*x^2) (- mu^2)
+                    squareSums[d] += sample[d] * sample[d] * probability;
+                }
             }
-        }
 
-        newLogLikelihood += probLogSumExp;
+            statistics.logLikelihood += probLogSumExp;
+        }
     }
-
-    return newLogLikelihood;
 }
 
-void GMModel::M(const std::vector< DynamicVector<Real> >& samples)
+void GMModel::M(Real frameCount, const Statistics& statistics)
 {
-    for (auto& cluster : mClusters)
+    unsigned int dimensionCount = GetDimensionCount();
+
+    for (unsigned int c = 0; c < mClusters.size(); ++c)
     {
-        Real invMembershipProbabilitySum = 1.0f / cluster.membershipProbabilitySum;
+        Cluster& cluster = mClusters[c];
 
-        for (unsigned int d = 0; d < mClusters[0].means.GetSize(); ++d)
-        {
-            cluster.means[d] = cluster.meansTmp[d] * invMembershipProbabilitySum;
-            cluster.variances[d] = cluster.variancesTmp[d] * invMembershipProbabilitySum - cluster.means[d] * cluster.means[d];
+        Real membershipProbabilitySum = statistics.probabilitySums[c];
+        Real invMembershipProbabilitySum = 1.0f / membershipProbabilitySum;
 
-            // Limit variance value.
-            // When multiplying many numbers with values < 1.0 it is likely that
-            // the value goes near zero and it causes instability in the implementation especially
-            // when using a diagonal covariance matrix.
+        const Real* meanSums = &statistics.meanSums[static_cast<std::size_t>(c) * dimensionCount];
+        const Real* squareSums = &statistics.squareSums[static_cast<std::size_t>(c) * dimensionCount];
 
-            if (cluster.variances[d] < 1.0e-5f)
+        // A cluster below the posterior threshold on every frame keeps its
+        // parameters and gets zero weight.
+        if (membershipProbabilitySum > 0.0f)
+        {
+            for (unsigned int d = 0; d < dimensionCount; ++d)
             {
-                cluster.variances[d] = 1.0e-5f;
+                cluster.means[d] = meanSums[d] * invMembershipProbabilitySum;
+                cluster.variances[d] = squareSums[d] * invMembershipProbabilitySum - cluster.means[d] * cluster.means[d];
+
+                // Limit variance value.
+                // When multiplying many numbers with values < 1.0 it is likely that
+                // the value goes near zero and it causes instability in the implementation especially
+                // when using a diagonal covariance matrix.
+
+                if (cluster.variances[d] < 1.0e-5f)
+                {
+                    cluster.variances[d] = 1.0e-5f;
+                }
             }
         }
 
-        cluster.mixingCoefficient = cluster.membershipProbabilitySum / static_cast<Real>(samples.size());
+        cluster.mixingCoefficient = membershipProbabilitySum / frameCount;
 
         UpdatePDF(cluster);
     }
+
+    UpdateKernel();
 }
 
-Real GMModel::GetLogLikelihood(const DynamicVector<Real>& values, const Cluster& cluster) const
+void GMModel::CopyClusters(const GMModel& model)
 {
-    Real v = 0.0f;
+    SetOrder(model.GetOrder());
+    Init();
 
-    for (unsigned int d = 0; d < mClusters[0].means.GetSize(); ++d)
+    for (unsigned int c = 0; c < GetOrder(); c++)
+    {
+        mClusters[c].means = model.mClusters[c].means;
+        mClusters[c].variances = model.mClusters[c].variances;
+        mClusters[c].mixingCoefficient = model.mClusters[c].mixingCoefficient;
+
+        mClusters[c].variancesInv = model.mClusters[c].variancesInv;
+    }
+
+    for (auto& cluster : mClusters)
+    {
+        UpdatePDF(cluster);
+    }
+
+    UpdateKernel();
+}
+
+Real GMModel::GetMergeCost(const Cluster& a, const Cluster& b, Real logDeterminantA, Real logDeterminantB) const
+{
+    Real weight = a.mixingCoefficient + b.mixingCoefficient;
+
+    if (weight <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    Real wa = a.mixingCoefficient / weight;
+    Real wb = b.mixingCoefficient / weight;
+
+    Real logDeterminant = 0.0f;
+
+    for (unsigned int d = 0; d < a.means.GetSize(); ++d)
+    {
+        Real difference = a.means[d] - b.means[d];
+
+        logDeterminant += std::log(wa * a.variances[d] + wb * b.variances[d] + wa * wb * difference * difference);
+    }
+
+    return 0.5f * (weight * logDeterminant - a.mixingCoefficient * logDeterminantA - b.mixingCoefficient * logDeterminantB);
+}
+
+void GMModel::MergeClusters(Cluster& target, const Cluster& other) const
+{
+    Real weight = target.mixingCoefficient + other.mixingCoefficient;
+
+    if (weight <= 0.0f)
+    {
+        return;
+    }
+
+    Real wa = target.mixingCoefficient / weight;
+    Real wb = other.mixingCoefficient / weight;
+
+    for (unsigned int d = 0; d < target.means.GetSize(); ++d)
+    {
+        Real difference = target.means[d] - other.means[d];
+
+        // The variance of the pair around the merged mean.
+        target.variances[d] = wa * target.variances[d] + wb * other.variances[d] + wa * wb * difference * difference;
+        target.means[d] = wa * target.means[d] + wb * other.means[d];
+    }
+
+    target.mixingCoefficient = weight;
+}
+
+Real GMModel::GetLogDeterminant(const Cluster& cluster) const
+{
+    Real logDeterminant = 0.0f;
+
+    for (unsigned int d = 0; d < cluster.variances.GetSize(); ++d)
     {
-        Real tmp = values[d] - cluster.means[d];
-        v += tmp * tmp * cluster.variancesInv[d];
+        logDeterminant += std::log(cluster.variances[d]);
     }
 
-    return (cluster.pdfConstant - 0.5f * v) + std::log(cluster.mixingCoefficient);
+    return logDeterminant;
 }
 
 void GMModel::UpdatePDF(Cluster& cluster)
@@ -417,3 +1039,15 @@ void GMModel::UpdatePDF(Cluster& cluster)
 
     cluster.pdfConstant = -0.5f * constant;
 }
+
+void GMModel::UpdateKernel()
+{
+    mKernel.Resize(mClusters.size(), GetDimensionCount());
+
+    for (unsigned int c = 0; c < mClusters.size(); ++c)
+    {
+        const Cluster& cluster = mClusters[c];
+
+        mKernel.SetComponent(c, &cluster.means[0], &cluster.variances[0], cluster.mixingCoefficient);
+    }
+}
@@ -0,0 +1,211 @@
+#include "GMModelBank.h"
+
+GMModelBank::GMModelBank()
+    : mModelCount(0),
+    mComponentCount(0),
+    mStride(0)
+{
+
+}
+
+GMModelBank::~GMModelBank()
+{
+
+}
+
+bool GMModelBank::Build(const std::vector<const GMModel*>& models)
+{
+    mModelCount = 0;
+
+    if (models.empty())
+    {
+        return false;
+    }
+
+    for (const GMModel* model : models)
+    {
+        if (!IsSharedStructure(*models[0], *model))
+        {
+            return false;
+        }
+    }
+
+    const std::vector<GMModel::Cluster>& shared = models[0]->GetClusters();
+
+    unsigned int dimensionCount = models[0]->GetDimensionCount();
+
+    mModelCount = models.size();
+    mComponentCount = shared.size();
+    mStride = MixtureKernel::GetPaddedSize(dimensionCount);
+
+    std::vector<Real> zeros(dimensionCount, 0.0);
+
+    mSharedKernel.Resize(mComponentCount, dimensionCount);
+    mSharedKernel.SetExpAccuracy(models[0]->GetExpAccuracy());
+    mSharedKernel.SetExpTolerance(models[0]->GetExpTolerance());
+
+    for (unsigned int c = 0; c < mComponentCount; ++c)
+    {
+        mSharedKernel.SetComponent(c, zeros.data(), &shared[c].variances[0], shared[c].mixingCoefficient);
+    }
+
+    mScaledMeans.assign(static_cast<std::size_t>(mModelCount) * mComponentCount * mStride, 0.0);
+    mMeanTerms.resize(static_cast<std::size_t>(mModelCount) * mComponentCount);
+
+    for (unsigned int m = 0; m < mModelCount; ++m)
+    {
+        const std::vector<GMModel::Cluster>& clusters = models[m]->GetClusters();
+
+        for (unsigned int c = 0; c < mComponentCount; ++c)
+        {
+            std::size_t row = static_cast<std::size_t>(m) * mComponentCount + c;
+
+            Real* scaledMeans = &mScaledMeans[row * mStride];
+
+            Real meanTerm = 0.0;
+
+            for (unsigned int d = 0; d < dimensionCount; ++d)
+            {
+                Real precision = 1.0 / shared[c].variances[d];
+
+                scaledMeans[d] = clusters[c].means[d] * precision;
+                meanTerm += clusters[c].means[d] * clusters[c].means[d] * precision;
+            }
+
+            mMeanTerms[row] = -0.5 * meanTerm;
+        }
+    }
+
+    return true;
+}
+
+unsigned int GMModelBank::GetModelCount() const
+{
+    return mModelCount;
+}
+
+void GMModelBank::GetLogLikelihoods(const FrameView& samples, std::vector<Real>& logLikelihoods, ScoringWorkspace& workspace) const
+{
+    std::vector<unsigned int> models(mModelCount);
+
+    for (unsigned int m = 0; m < mModelCount; ++m)
+    {
+        models[m] = m;
+    }
+
+    GetLogLikelihoods(samples, models, logLikelihoods, workspace);
+}
+
+void GMModelBank::GetLogLikelihoods(const FrameView& samples, const std::vector<unsigned int>& models,
+                                    std::vector<Real>& logLikelihoods, ScoringWorkspace& workspace) const
+{
+    logLikelihoods.assign(models.size(), 0.0);
+
+    if (samples.GetFrameCount() == 0 || models.empty() || mComponentCount == 0)
+    {
+        return;
+    }
+
+    // Tiles hold whole models, at least one.
+    unsigned int tileModelCount = Max(TILE_ROWS / mComponentCount, 1u);
+
+    // Each tile is a run of consecutive models, so its mean rows are contiguous.
+    std::vector<unsigned int> tileBegins;
+
+    for (unsigned int i = 0; i < models.size(); ++i)
+    {
+        if (   tileBegins.empty()
+            || i - tileBegins.back() == tileModelCount
+            || models[i] != models[i - 1] + 1)
+        {
+            tileBegins.push_back(i);
+        }
+    }
+
+    tileBegins.push_back(models.size());
+
+    std::vector<Real>& sharedTerms = workspace.values;
+    std::vector<Real>& products = workspace.products;
+
+    sharedTerms.resize(static_cast<std::size_t>(MixtureKernel::BUFFER_FRAMES) * mComponentCount);
+    products.resize(static_cast<std::size_t>(MixtureKernel::BUFFER_FRAMES) * tileModelCount * mComponentCount);
+
+    std::vector<Real> values(mComponentCount);
+
+    Real invN = 1.0 / static_cast<Real>(samples.GetFrameCount());
+
+    std::size_t mismatches = 0;
+
+    for (unsigned int begin = 0; begin < samples.GetFrameCount(); begin += MixtureKernel::BUFFER_FRAMES)
+    {
+        unsigned int end = Min(begin + MixtureKernel::BUFFER_FRAMES, samples.GetFrameCount());
+
+        mSharedKernel.GetLogLikelihoods(samples, begin, end, sharedTerms.data());
+
+        for (unsigned int t = 0; t + 1 < tileBegins.size(); ++t)
+        {
+            unsigned int first = models[tileBegins[t]];
+            unsigned int tileSize = tileBegins[t + 1] - tileBegins[t];
+            unsigned int rowCount = tileSize * mComponentCount;
+
+            const Real* scaledMeans = &mScaledMeans[static_cast<std::size_t>(first) * mComponentCount * mStride];
+
+            MixtureKernel::GetDotProducts(samples, begin, end, scaledMeans, rowCount, mStride, products.data());
+
+            for (unsigned int n = begin; n < end; ++n)
+            {
+                const Real* shared = &sharedTerms[static_cast<std::size_t>(n - begin) * mComponentCount];
+                const Real* frameProducts = &products[static_cast<std::size_t>(n - begin) * rowCount];
+
+                for (unsigned int i = 0; i < tileSize; ++i)
+                {
+                    const Real* modelProducts = frameProducts + static_cast<std::size_t>(i) * mComponentCount;
+                    const Real* meanTerms = &mMeanTerms[static_cast<std::size_t>(first + i) * mComponentCount];
+
+                    for (unsigned int c = 0; c < mComponentCount; ++c)
+                    {
+                        values[c] = shared[c] + meanTerms[c] + modelProducts[c];
+                    }
+
+                    logLikelihoods[tileBegins[t] + i] += mSharedKernel.GetLogSumExp(values.data(), mComponentCount, mismatches) * invN;
+                }
+            }
+        }
+    }
+
+    MixtureKernel::ReportMismatches(mismatches);
+}
+
+bool GMModelBank::IsSharedStructure(const GMModel& a, const GMModel& b)
+{
+    const std::vector<GMModel::Cluster>& clustersA = a.GetClusters();
+    const std::vector<GMModel::Cluster>& clustersB = b.GetClusters();
+
+    if (clustersA.size() != clustersB.size() || a.GetDimensionCount() != b.GetDimensionCount())
+    {
+        return false;
+    }
+
+    if (&a == &b)
+    {
+        return true;
+    }
+
+    for (unsigned int c = 0; c < clustersA.size(); ++c)
+    {
+        if (clustersA[c].mixingCoefficient != clustersB[c].mixingCoefficient)
+        {
+            return false;
+        }
+
+        for (unsigned int d = 0; d < a.GetDimensionCount(); ++d)
+        {
+            if (clustersA[c].variances[d] != clustersB[c].variances[d])
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
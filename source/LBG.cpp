@@ -1,7 +1,7 @@
 #include "LBG.h"
 
 LBG::LBG(unsigned int clusterCount, Real eta)
-    : mClusterCount(clusterCount), mEta(eta)
+    : mClusterCount(clusterCount), mEta(eta), mBoundsEnabled(true)
 {
 
 }
@@ -21,15 +21,25 @@ unsigned int LBG::GetClusterCount() const
     return mClusterCount;
 }
 
+void LBG::SetBoundsEnabled(bool enabled)
+{
+    mBoundsEnabled = enabled;
+}
+
+bool LBG::IsBoundsEnabled() const
+{
+    return mBoundsEnabled;
+}
+
 void LBG::Cluster(
-    const std::vector< DynamicVector<Real> >& samples,
+    const FrameView& samples,
     std::vector<unsigned int>& indices,
     std::vector< DynamicVector<Real> >& centroids,
     std::vector<unsigned int>& sizes)
 {
-    if (indices.size() != samples.size())
+    if (indices.size() != samples.GetFrameCount())
     {
-        indices.resize(samples.size());
+        indices.resize(samples.GetFrameCount());
     }
     
     if (centroids.size() != mClusterCount)
@@ -46,32 +56,35 @@ void LBG::Cluster(
 
     for (auto& centroid : centroids)
     {
-        centroid.Resize(samples[0].GetSize(), 0.0f);
+        centroid.Resize(samples.GetDimensionCount(), 0.0f);
     }
 
     // Create the initial centroid by averaging sample data.
 
     centroids[0].Assign(0.0f);
 
-    for (const auto& sample : samples)
+    for (unsigned int s = 0; s < samples.GetFrameCount(); ++s)
     {
-        centroids[0].Add(sample);
+        centroids[0].Add(samples[s]);
     }
 
-    centroids[0].Multiply(1.0f / static_cast<Real>(samples.size()));
+    centroids[0].Multiply(1.0f / static_cast<Real>(samples.GetFrameCount()));
 
     // Cluster counter.
     unsigned int n = 1;
 
+    CentroidAssignment assignment;
+    assignment.SetBoundsEnabled(mBoundsEnabled);
+
     // Average distortion.
     Real avgDist = 0.0f;
 
-    for (const auto& sample : samples)
+    for (unsigned int s = 0; s < samples.GetFrameCount(); ++s)
     {
-        avgDist += sample.Distance(centroids[0]);
+        avgDist += centroids[0].Distance(samples[s]);
     }
 
-    avgDist /= static_cast<Real>(samples.size() * centroids[0].GetSize());
+    avgDist /= static_cast<Real>(samples.GetFrameCount() * centroids[0].GetSize());
 
     do
     {
@@ -84,26 +97,8 @@ void LBG::Cluster(
 
         while (true)
         {
-            // Find closest centroid for each sample.
-            for (unsigned int s = 0; s < samples.size(); ++s)
-            {
-                Real minDist = std::numeric_limits<Real>::max();
-
-                unsigned int minC = -1;
-
-                for (unsigned int c = 0; c < n; ++c)
-                {
-                    Real dist = samples[s].Distance(centroids[c]);
-
-                    if (dist < minDist)
-                    {
-                        minDist = dist;
-                        minC = c;
-                    }
-                }
-
-                indices[s] = minC;
-            }
+            // Find closest centroid for each sample, the bounds are reset by a split.
+            assignment.Assign(samples, centroids, n, indices);
 
             // Update centroids.
             for (unsigned int c = 0; c < n; ++c)
@@ -113,7 +108,7 @@ void LBG::Cluster(
                 sizes[c] = 0;
             }
 
-            for (unsigned int s = 0; s < samples.size(); ++s)
+            for (unsigned int s = 0; s < samples.GetFrameCount(); ++s)
             {
                 centroids[indices[s]].Add(samples[s]);
 
@@ -130,12 +125,12 @@ void LBG::Cluster(
 
             Real newAvgDist = 0.0f;
 
-            for (unsigned int s = 0; s < samples.size(); ++s)
+            for (unsigned int s = 0; s < samples.GetFrameCount(); ++s)
             {
-                newAvgDist += samples[s].Distance(centroids[indices[s]]);
+                newAvgDist += centroids[indices[s]].Distance(samples[s]);
             }
 
-            newAvgDist /= static_cast<Real>(samples.size() * centroids[0].GetSize());
+            newAvgDist /= static_cast<Real>(samples.GetFrameCount() * centroids[0].GetSize());
 
             if (((avgDist - newAvgDist) / avgDist) > mEta)
             {
@@ -0,0 +1,210 @@
+#include "LineIndex.h"
+
+namespace
+{
+    const char* const INDEX_HEADER = "LineIndex";
+    const unsigned int INDEX_VERSION = 2;
+}
+
+LineIndex::LineIndex()
+    : mSize(0),
+    mModificationTime(0)
+{
+
+}
+
+LineIndex::~LineIndex()
+{
+
+}
+
+bool LineIndex::Load(const std::string& path)
+{
+    mPath = path;
+
+    if (Read(GetIndexPath(path)) && IsCurrent())
+    {
+        return true;
+    }
+
+    return Build(path);
+}
+
+bool LineIndex::Build(const std::string& path)
+{
+    mPath = path;
+    mLineOffsets.clear();
+
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.good())
+    {
+        return false;
+    }
+
+    mSize = GetFileSize(path);
+    mModificationTime = GetFileModificationTime(path);
+
+    std::vector<char> buffer(1 << 20);
+
+    // A line starts at the beginning of the file and after every newline, except at the end of the file.
+    std::uint64_t offset = 0;
+    bool lineStart = true;
+
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+    {
+        std::size_t count = file.gcount();
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (lineStart)
+            {
+                mLineOffsets.push_back(offset + i);
+                lineStart = false;
+            }
+
+            if (buffer[i] == '\n')
+            {
+                lineStart = true;
+            }
+        }
+
+        offset += count;
+    }
+
+    if (!Write(GetIndexPath(path)))
+    {
+        std::cout << "Could not save line index: " << GetIndexPath(path) << std::endl;
+    }
+
+    return true;
+}
+
+bool LineIndex::IsCurrent() const
+{
+    return mSize == GetFileSize(mPath) && mModificationTime == GetFileModificationTime(mPath);
+}
+
+unsigned int LineIndex::GetLineCount() const
+{
+    return mLineOffsets.size();
+}
+
+std::uint64_t LineIndex::GetLineOffset(unsigned int line) const
+{
+    return mLineOffsets[line - 1];
+}
+
+std::shared_ptr<const LineIndex> LineIndex::Get(const std::string& path)
+{
+    // Each file has its own lock so that different files can be indexed in parallel.
+    struct Slot
+    {
+        std::mutex mutex;
+        std::shared_ptr<const LineIndex> index;
+    };
+
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<Slot> > slots;
+
+    std::shared_ptr<Slot> slot;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto& entry = slots[path];
+
+        if (!entry)
+        {
+            entry = std::make_shared<Slot>();
+        }
+
+        slot = entry;
+    }
+
+    std::lock_guard<std::mutex> lock(slot->mutex);
+
+    if (!slot->index || !slot->index->IsCurrent())
+    {
+        auto index = std::make_shared<LineIndex>();
+
+        if (!index->Load(path))
+        {
+            slot->index.reset();
+            return nullptr;
+        }
+
+        slot->index = index;
+    }
+
+    return slot->index;
+}
+
+std::string LineIndex::GetIndexPath(const std::string& path)
+{
+    return path + ".idx";
+}
+
+bool LineIndex::Read(const std::string& indexPath)
+{
+    mLineOffsets.clear();
+
+    std::ifstream file(indexPath);
+
+    std::string header;
+    unsigned int version = 0;
+    unsigned int lineCount = 0;
+
+    if (!(file >> header >> version) || header != INDEX_HEADER || version != INDEX_VERSION)
+    {
+        return false;
+    }
+
+    if (!(file >> mSize >> mModificationTime >> lineCount))
+    {
+        return false;
+    }
+
+    mLineOffsets.resize(lineCount);
+
+    for (auto& offset : mLineOffsets)
+    {
+        if (!(file >> offset))
+        {
+            mLineOffsets.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LineIndex::Write(const std::string& indexPath) const
+{
+    // Written to a temporary file first so that other processes never see a partial index.
+    std::string tempPath = indexPath + ".tmp";
+
+    {
+        std::ofstream file(tempPath);
+
+        if (!file.good())
+        {
+            return false;
+        }
+
+        file << INDEX_HEADER << " " << INDEX_VERSION << std::endl;
+        file << mSize << " " << mModificationTime << " " << mLineOffsets.size() << std::endl;
+
+        for (auto offset : mLineOffsets)
+        {
+            file << offset << '\n';
+        }
+
+        if (!file.good())
+        {
+            return false;
+        }
+    }
+
+    return std::rename(tempPath.c_str(), indexPath.c_str()) == 0;
+}
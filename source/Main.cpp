@@ -9,6 +9,9 @@
 
 #include "TestEngine.h"
 
+#include "FeatureFile.h"
+#include "MfccExtractor.h"
+
 int main(int argc, char** argv)
 {
     // !!!!!!!!
@@ -19,6 +22,46 @@ int main(int argc, char** argv)
 
     //std::freopen("output.txt", "w", stdout);
 
+    // Convert text feature files to the binary format:
+    // -convert [folder/samples_1.txt] [folder/samples_2.txt] ...
+    if (argc >= 2 && std::string(argv[1]) == "-convert")
+    {
+        int failures = 0;
+
+        for (int i = 2; i < argc; ++i)
+        {
+            if (!ConvertTextSamples(argv[i], GetBinarySamplesPath(argv[i])))
+            {
+                ++failures;
+            }
+        }
+
+        return failures;
+    }
+
+    // Extract MFCC features from WAVE files listed as "[label] [path]" lines:
+    // -extract [list file] [folder/samples_1.txt or folder/samples_1.bin] [-vad]
+    if (argc >= 2 && std::string(argv[1]) == "-extract")
+    {
+        if (argc != 4 && !(argc == 5 && std::string(argv[4]) == "-vad"))
+        {
+            std::cout << "Usage: -extract [list file] [output file] [-vad]" << std::endl;
+            return 1;
+        }
+
+        std::vector<AudioFile> files;
+
+        if (!LoadAudioFileList(argv[2], files))
+        {
+            return 1;
+        }
+
+        MfccExtractor extractor;
+        extractor.SetVoiceActivityDetection(argc == 5);
+
+        return ExtractFeatures(files, extractor, argv[3]) ? 0 : 1;
+    }
+
     TestEngine engine;
     
     if (argc >= 2)
@@ -0,0 +1,117 @@
+#include "MeanVarianceNormalizer.h"
+
+MeanVarianceNormalizer::MeanVarianceNormalizer(unsigned int dimensionCount)
+{
+    Reset(dimensionCount);
+}
+
+MeanVarianceNormalizer::~MeanVarianceNormalizer()
+{
+
+}
+
+void MeanVarianceNormalizer::Reset()
+{
+    Reset(mDimensionCount);
+}
+
+void MeanVarianceNormalizer::Reset(unsigned int dimensionCount)
+{
+    mDimensionCount = dimensionCount;
+    mFrameCount = 0;
+
+    mMeans.assign(dimensionCount, 0.0);
+    mSquareSums.assign(dimensionCount, 0.0);
+    mScales.assign(dimensionCount, 0.0);
+
+    mScalesValid = false;
+}
+
+unsigned int MeanVarianceNormalizer::GetDimensionCount() const
+{
+    return mDimensionCount;
+}
+
+unsigned int MeanVarianceNormalizer::GetFrameCount() const
+{
+    return mFrameCount;
+}
+
+void MeanVarianceNormalizer::Add(const Real* frame)
+{
+    ++mFrameCount;
+
+    Real invCount = 1.0 / mFrameCount;
+
+    Real* means = mMeans.data();
+    Real* squareSums = mSquareSums.data();
+
+    // Welford's update for all dimensions at once.
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        Real delta = frame[d] - means[d];
+        means[d] += delta * invCount;
+        squareSums[d] += delta * (frame[d] - means[d]);
+    }
+
+    mScalesValid = false;
+}
+
+void MeanVarianceNormalizer::Add(const FrameView& frames)
+{
+    for (unsigned int f = 0; f < frames.GetFrameCount(); ++f)
+    {
+        Add(frames[f]);
+    }
+}
+
+Real MeanVarianceNormalizer::GetMean(unsigned int dimension) const
+{
+    return mMeans[dimension];
+}
+
+Real MeanVarianceNormalizer::GetVariance(unsigned int dimension) const
+{
+    if (mFrameCount < 2)
+    {
+        return 0.0;
+    }
+
+    return mSquareSums[dimension] / (mFrameCount - 1);
+}
+
+void MeanVarianceNormalizer::Normalize(Real* frame)
+{
+    if (!mScalesValid)
+    {
+        UpdateScales();
+    }
+
+    const Real* means = mMeans.data();
+    const Real* scales = mScales.data();
+
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        frame[d] = (frame[d] - means[d]) * scales[d];
+    }
+}
+
+void MeanVarianceNormalizer::Normalize(FrameMatrix& frames, unsigned int begin, unsigned int end)
+{
+    for (unsigned int f = begin; f < end; ++f)
+    {
+        Normalize(frames[f]);
+    }
+}
+
+void MeanVarianceNormalizer::UpdateScales()
+{
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        Real deviation = std::sqrt(GetVariance(d));
+
+        mScales[d] = (deviation > 0.0) ? 1.0 / deviation : 1.0;
+    }
+
+    mScalesValid = true;
+}
@@ -0,0 +1,530 @@
+#include "MfccExtractor.h"
+
+#include "FeatureFile.h"
+#include "RealFFT.h"
+#include "SpeechData.h"
+#include "ThreadPool.h"
+#include "WaveFile.h"
+
+#include <atomic>
+#include <filesystem>
+
+namespace
+{
+    Real HzToMel(Real hz)
+    {
+        return 2595.0 * std::log10(1.0 + hz / 700.0);
+    }
+
+    Real MelToHz(Real mel)
+    {
+        return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0);
+    }
+}
+
+MfccExtractor::MfccExtractor()
+    : mFrameLength(0.025),
+    mFrameStep(0.01),
+    mFftSize(512),
+    mFilterCount(26),
+    mCepstrumCount(13),
+    mLowFrequency(0.0),
+    mHighFrequency(0.0),
+    mPreemphasis(0.97),
+    mLifter(22.0),
+    mEnergyAppended(true),
+    mDeltaOrder(2),
+    mDeltaWindow(2),
+    mVoiceActivityDetection(false)
+{
+
+}
+
+MfccExtractor::~MfccExtractor()
+{
+
+}
+
+void MfccExtractor::SetFraming(Real frameLength, Real frameStep)
+{
+    mFrameLength = frameLength;
+    mFrameStep = frameStep;
+}
+
+Real MfccExtractor::GetFrameLength() const
+{
+    return mFrameLength;
+}
+
+Real MfccExtractor::GetFrameStep() const
+{
+    return mFrameStep;
+}
+
+void MfccExtractor::SetFftSize(unsigned int fftSize)
+{
+    mFftSize = fftSize;
+}
+
+unsigned int MfccExtractor::GetFftSize() const
+{
+    return mFftSize;
+}
+
+void MfccExtractor::SetFilterCount(unsigned int filterCount)
+{
+    mFilterCount = filterCount;
+}
+
+unsigned int MfccExtractor::GetFilterCount() const
+{
+    return mFilterCount;
+}
+
+void MfccExtractor::SetCepstrumCount(unsigned int cepstrumCount)
+{
+    mCepstrumCount = cepstrumCount;
+}
+
+unsigned int MfccExtractor::GetCepstrumCount() const
+{
+    return mCepstrumCount;
+}
+
+void MfccExtractor::SetFrequencyRange(Real lowFrequency, Real highFrequency)
+{
+    mLowFrequency = lowFrequency;
+    mHighFrequency = highFrequency;
+}
+
+void MfccExtractor::SetPreemphasis(Real preemphasis)
+{
+    mPreemphasis = preemphasis;
+}
+
+void MfccExtractor::SetLifter(Real lifter)
+{
+    mLifter = lifter;
+}
+
+void MfccExtractor::SetEnergyAppended(bool energyAppended)
+{
+    mEnergyAppended = energyAppended;
+}
+
+void MfccExtractor::SetDeltaOrder(unsigned int deltaOrder)
+{
+    mDeltaOrder = Min(deltaOrder, 2u);
+}
+
+unsigned int MfccExtractor::GetDeltaOrder() const
+{
+    return mDeltaOrder;
+}
+
+void MfccExtractor::SetDeltaWindow(unsigned int deltaWindow)
+{
+    mDeltaWindow = Max(deltaWindow, 1u);
+}
+
+void MfccExtractor::SetVoiceActivityDetection(bool enabled)
+{
+    mVoiceActivityDetection = enabled;
+}
+
+bool MfccExtractor::IsVoiceActivityDetectionEnabled() const
+{
+    return mVoiceActivityDetection;
+}
+
+void MfccExtractor::SetVoiceActivityDetector(const VoiceActivityDetector& detector)
+{
+    mVoiceActivityDetector = detector;
+}
+
+const VoiceActivityDetector& MfccExtractor::GetVoiceActivityDetector() const
+{
+    return mVoiceActivityDetector;
+}
+
+unsigned int MfccExtractor::GetDimensionCount() const
+{
+    return mCepstrumCount * (mDeltaOrder + 1);
+}
+
+bool MfccExtractor::Extract(const std::vector<Real>& signal, unsigned int sampleRate, FrameMatrix& features) const
+{
+    features.SetDimensionCount(GetDimensionCount());
+
+    unsigned int frameLength = static_cast<unsigned int>(std::lround(mFrameLength * sampleRate));
+    unsigned int frameStep = static_cast<unsigned int>(std::lround(mFrameStep * sampleRate));
+
+    if (   signal.empty() || frameLength == 0 || frameStep == 0
+        || mFftSize < 2 || (mFftSize & (mFftSize - 1)) != 0
+        || mFilterCount == 0 || mCepstrumCount == 0 || mCepstrumCount > mFilterCount)
+    {
+        std::cout << "Could not extract features: invalid signal or options." << std::endl;
+        return false;
+    }
+
+    unsigned int binCount = mFftSize / 2 + 1;
+
+    // Frames cover the whole signal, the last frame is padded with zeros.
+    unsigned int frameCount = 1;
+
+    if (signal.size() > frameLength)
+    {
+        frameCount += (signal.size() - frameLength + frameStep - 1) / frameStep;
+    }
+
+    std::vector<Real> emphasized(signal.size());
+
+    emphasized[0] = signal[0];
+
+    for (std::size_t i = 1; i < signal.size(); ++i)
+    {
+        emphasized[i] = signal[i] - mPreemphasis * signal[i - 1];
+    }
+
+    RealFFT fft(mFftSize);
+
+    std::vector<Real> filterBank = GetFilterBank(sampleRate);
+
+    // Orthonormal DCT-II with the lifter applied to the rows.
+    std::vector<Real> dct(mCepstrumCount * mFilterCount);
+
+    for (unsigned int k = 0; k < mCepstrumCount; ++k)
+    {
+        Real scale = std::sqrt(((k == 0) ? 1.0 : 2.0) / mFilterCount);
+
+        if (mLifter > 0.0)
+        {
+            scale *= 1.0 + 0.5 * mLifter * std::sin(3.14159265358979323846 * k / mLifter);
+        }
+
+        for (unsigned int n = 0; n < mFilterCount; ++n)
+        {
+            dct[k * mFilterCount + n] = scale * std::cos(3.14159265358979323846 * k * (2 * n + 1) / (2.0 * mFilterCount));
+        }
+    }
+
+    std::vector<Real> frame(mFftSize);
+    std::vector<Real> power(binCount);
+    std::vector<Real> logEnergies(mFilterCount);
+
+    const Real epsilon = std::numeric_limits<Real>::epsilon();
+    const Real invFftSize = 1.0 / mFftSize;
+
+    features.Reserve(frameCount);
+
+    for (unsigned int t = 0; t < frameCount; ++t)
+    {
+        std::size_t start = static_cast<std::size_t>(t) * frameStep;
+
+        // Frames longer than the FFT are truncated.
+        unsigned int length = Min(frameLength, mFftSize);
+
+        for (unsigned int i = 0; i < mFftSize; ++i)
+        {
+            frame[i] = (i < length && start + i < emphasized.size()) ? emphasized[start + i] : 0.0;
+        }
+
+        fft.GetPowerSpectrum(frame.data(), power.data());
+
+        Real energy = 0.0;
+
+        for (unsigned int k = 0; k < binCount; ++k)
+        {
+            power[k] *= invFftSize;
+            energy += power[k];
+        }
+
+        for (unsigned int j = 0; j < mFilterCount; ++j)
+        {
+            const Real* weights = &filterBank[j * binCount];
+
+            Real sum = 0.0;
+
+            for (unsigned int k = 0; k < binCount; ++k)
+            {
+                sum += weights[k] * power[k];
+            }
+
+            logEnergies[j] = std::log((sum > 0.0) ? sum : epsilon);
+        }
+
+        Real* values = features.AddFrame();
+
+        for (unsigned int k = 0; k < mCepstrumCount; ++k)
+        {
+            const Real* row = &dct[k * mFilterCount];
+
+            Real sum = 0.0;
+
+            for (unsigned int n = 0; n < mFilterCount; ++n)
+            {
+                sum += row[n] * logEnergies[n];
+            }
+
+            values[k] = sum;
+        }
+
+        if (mEnergyAppended)
+        {
+            values[0] = std::log((energy > 0.0) ? energy : epsilon);
+        }
+    }
+
+    // Deltas, then deltas of the deltas.
+    for (unsigned int order = 0; order < mDeltaOrder; ++order)
+    {
+        AppendDeltas(features, order * mCepstrumCount, mCepstrumCount);
+    }
+
+    // Deltas are computed before removing frames so that they use the original neighbours.
+    if (mVoiceActivityDetection)
+    {
+        VoiceActivityDetector detector = mVoiceActivityDetector;
+        detector.Filter(features, 0);
+    }
+
+    return true;
+}
+
+bool MfccExtractor::Extract(const std::string& path, FrameMatrix& features) const
+{
+    WaveFile file;
+
+    if (!file.Load(path))
+    {
+        features.SetDimensionCount(GetDimensionCount());
+        return false;
+    }
+
+    return Extract(file.GetSamples(), file.GetSampleRate(), features);
+}
+
+std::vector<Real> MfccExtractor::GetFilterBank(unsigned int sampleRate) const
+{
+    unsigned int binCount = mFftSize / 2 + 1;
+
+    Real highFrequency = (mHighFrequency > 0.0) ? mHighFrequency : sampleRate / 2.0;
+
+    Real lowMel = HzToMel(mLowFrequency);
+    Real highMel = HzToMel(highFrequency);
+
+    // Filter edges as FFT bins, equally spaced on the mel scale.
+    std::vector<unsigned int> bins(mFilterCount + 2);
+
+    for (unsigned int i = 0; i < bins.size(); ++i)
+    {
+        Real mel = lowMel + (highMel - lowMel) * i / (mFilterCount + 1);
+        bins[i] = static_cast<unsigned int>(std::floor((mFftSize + 1) * MelToHz(mel) / sampleRate));
+    }
+
+    std::vector<Real> filterBank(mFilterCount * binCount, 0.0);
+
+    for (unsigned int j = 0; j < mFilterCount; ++j)
+    {
+        Real* weights = &filterBank[j * binCount];
+
+        for (unsigned int k = bins[j]; k < bins[j + 1] && k < binCount; ++k)
+        {
+            weights[k] = static_cast<Real>(k - bins[j]) / (bins[j + 1] - bins[j]);
+        }
+
+        for (unsigned int k = bins[j + 1]; k < bins[j + 2] && k < binCount; ++k)
+        {
+            weights[k] = static_cast<Real>(bins[j + 2] - k) / (bins[j + 2] - bins[j + 1]);
+        }
+    }
+
+    return filterBank;
+}
+
+void MfccExtractor::AppendDeltas(FrameMatrix& features, unsigned int offset, unsigned int count) const
+{
+    unsigned int frameCount = features.GetFrameCount();
+
+    Real denominator = 0.0;
+
+    for (unsigned int n = 1; n <= mDeltaWindow; ++n)
+    {
+        denominator += n * n;
+    }
+
+    Real scale = 0.5 / denominator;
+
+    for (unsigned int t = 0; t < frameCount; ++t)
+    {
+        Real* deltas = features[t] + offset + count;
+
+        for (unsigned int n = 1; n <= mDeltaWindow; ++n)
+        {
+            // Frames outside the utterance are replaced by the first and the last frame.
+            const Real* previous = features[(t >= n) ? t - n : 0] + offset;
+            const Real* next = features[Min(t + n, frameCount - 1)] + offset;
+
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                deltas[i] += n * (next[i] - previous[i]);
+            }
+        }
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            deltas[i] *= scale;
+        }
+    }
+}
+
+bool LoadAudioFileList(const std::string& path, std::vector<AudioFile>& files)
+{
+    std::ifstream file(path);
+
+    if (!file)
+    {
+        std::cout << "Could not open audio file list: " << path << std::endl;
+        return false;
+    }
+
+    std::filesystem::path folder = std::filesystem::path(path).parent_path();
+
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        std::stringstream ss(line);
+
+        AudioFile audioFile;
+
+        if (!(ss >> audioFile.label))
+        {
+            continue;
+        }
+
+        // The rest of the line is the path, which may contain spaces.
+        std::getline(ss >> std::ws, audioFile.path);
+
+        while (!audioFile.path.empty() && std::isspace(static_cast<unsigned char>(audioFile.path.back())))
+        {
+            audioFile.path.pop_back();
+        }
+
+        if (audioFile.path.empty())
+        {
+            std::cout << "Missing audio file path for '" << audioFile.label << "'." << std::endl;
+            return false;
+        }
+
+        if (std::filesystem::path(audioFile.path).is_relative())
+        {
+            audioFile.path = (folder / audioFile.path).string();
+        }
+
+        files.push_back(audioFile);
+    }
+
+    return true;
+}
+
+unsigned int ExtractFeatures(const std::vector<AudioFile>& files, const MfccExtractor& extractor, std::vector<FrameMatrix>& features)
+{
+    features.assign(files.size(), FrameMatrix(extractor.GetDimensionCount()));
+
+    std::atomic<unsigned int> failures(0);
+
+    ThreadPool::GetDefault().ParallelFor(files.size(), [&](unsigned int i) {
+        if (!extractor.Extract(files[i].path, features[i]))
+        {
+            std::cout << "Could not extract features: " << files[i].path << std::endl;
+            ++failures;
+        }
+    });
+
+    return failures;
+}
+
+unsigned int ExtractFeatures(const std::vector<AudioFile>& files, const MfccExtractor& extractor, SpeechData& data)
+{
+    std::vector<FrameMatrix> features;
+
+    unsigned int failures = ExtractFeatures(files, extractor, features);
+
+    for (unsigned int i = 0; i < files.size(); ++i)
+    {
+        if (features[i].GetFrameCount() > 0)
+        {
+            data.AddUtterance(files[i].label, features[i]);
+        }
+    }
+
+    data.Validate();
+
+    return failures;
+}
+
+bool ExtractFeatures(const std::vector<AudioFile>& files, const MfccExtractor& extractor, const std::string& outputPath)
+{
+    std::vector<FrameMatrix> features;
+
+    if (ExtractFeatures(files, extractor, features) > 0)
+    {
+        return false;
+    }
+
+    unsigned int dimensionCount = extractor.GetDimensionCount();
+
+    std::cout << "Writing features of " << files.size() << " files to '" << outputPath << "'." << std::endl;
+
+    std::string extension = std::filesystem::path(outputPath).extension().string();
+
+    if (extension == ".bin")
+    {
+        std::vector<std::string> labels;
+        std::vector<unsigned int> frameCounts;
+        std::vector<float> frames;
+
+        for (unsigned int i = 0; i < files.size(); ++i)
+        {
+            labels.push_back(files[i].label);
+            frameCounts.push_back(features[i].GetFrameCount());
+
+            for (unsigned int f = 0; f < features[i].GetFrameCount(); ++f)
+            {
+                frames.insert(frames.end(), features[i][f], features[i][f] + dimensionCount);
+            }
+        }
+
+        return FeatureFile::Write(outputPath, dimensionCount, labels, frameCounts, frames);
+    }
+
+    std::ofstream file(outputPath);
+
+    // Enough digits to reproduce the float values read by SpeechData::Load().
+    file << std::setprecision(9);
+
+    for (unsigned int i = 0; i < files.size(); ++i)
+    {
+        file << files[i].label << " ";
+
+        for (unsigned int f = 0; f < features[i].GetFrameCount(); ++f)
+        {
+            if (f > 0)
+            {
+                file << ",";
+            }
+
+            const Real* values = features[i][f];
+
+            for (unsigned int d = 0; d < dimensionCount; ++d)
+            {
+                file << (d > 0 ? " " : "") << values[d];
+            }
+        }
+
+        file << "\n";
+    }
+
+    return file.good();
+}
@@ -0,0 +1,828 @@
+#include "MixtureKernel.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    /*! \brief Component tables are padded to a multiple of this many values.
+     */
+    const unsigned int KERNEL_PADDING = FrameMatrix::ALIGNMENT / sizeof(Real);
+
+#if defined(__AVX512F__)
+    /*! \brief Computes the quadratic terms of BLOCK_FRAMES frames for one component.
+     */
+    inline void GetQuadraticTerms(const Real* const* frames, const Real* halfPrecisions, const Real* scaledMeans,
+                                  unsigned int dimensionCount, Real* output)
+    {
+        __m512d sums[MixtureKernel::BLOCK_FRAMES];
+
+        for (unsigned int i = 0; i < MixtureKernel::BLOCK_FRAMES; ++i)
+        {
+            sums[i] = _mm512_setzero_pd();
+        }
+
+        for (unsigned int d = 0; d < dimensionCount; d += 8)
+        {
+            // The tables are zero padded, only the frames need a mask.
+            __mmask8 mask = (dimensionCount - d >= 8) ? 0xFF : static_cast<__mmask8>((1u << (dimensionCount - d)) - 1);
+
+            __m512d halfPrecision = _mm512_load_pd(halfPrecisions + d);
+            __m512d scaledMean = _mm512_load_pd(scaledMeans + d);
+
+            for (unsigned int i = 0; i < MixtureKernel::BLOCK_FRAMES; ++i)
+            {
+                __m512d x = _mm512_maskz_loadu_pd(mask, frames[i] + d);
+                __m512d t = _mm512_fnmadd_pd(x, halfPrecision, scaledMean);
+                sums[i] = _mm512_fmadd_pd(x, t, sums[i]);
+            }
+        }
+
+        for (unsigned int i = 0; i < MixtureKernel::BLOCK_FRAMES; ++i)
+        {
+            output[i] = _mm512_reduce_add_pd(sums[i]);
+        }
+    }
+
+    /*! \brief Computes the dot products of BLOCK_FRAMES frames with one row.
+     */
+    inline void GetLinearTerms(const Real* const* frames, const Real* row, unsigned int dimensionCount, Real* output)
+    {
+        __m512d sums[MixtureKernel::BLOCK_FRAMES];
+
+        for (unsigned int i = 0; i < MixtureKernel::BLOCK_FRAMES; ++i)
+        {
+            sums[i] = _mm512_setzero_pd();
+        }
+
+        for (unsigned int d = 0; d < dimensionCount; d += 8)
+        {
+            __mmask8 mask = (dimensionCount - d >= 8) ? 0xFF : static_cast<__mmask8>((1u << (dimensionCount - d)) - 1);
+
+            __m512d values = _mm512_load_pd(row + d);
+
+            for (unsigned int i = 0; i < MixtureKernel::BLOCK_FRAMES; ++i)
+            {
+                sums[i] = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, frames[i] + d), values, sums[i]);
+            }
+        }
+
+        for (unsigned int i = 0; i < MixtureKernel::BLOCK_FRAMES; ++i)
+        {
+            output[i] = _mm512_reduce_add_pd(sums[i]);
+        }
+    }
+#elif defined(__AVX2__) && defined(__FMA__)
+    inline void GetQuadraticTerms(const Real* const* frames, const Real* halfPrecisions, const Real* scaledMeans,
+                                  unsigned int dimensionCount, Real* output)
+    {
+        static_assert(MixtureKernel::BLOCK_FRAMES == 4, "The horizontal sum assumes four frames.");
+
+        __m256d sums[4] = { _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd() };
+
+        for (unsigned int d = 0; d < dimensionCount; d += 4)
+        {
+            // The tables are zero padded, only the frames need a mask.
+            long long remaining = dimensionCount - d;
+
+            __m256i mask = _mm256_set_epi64x(remaining > 3 ? -1 : 0, remaining > 2 ? -1 : 0, remaining > 1 ? -1 : 0, -1);
+
+            __m256d halfPrecision = _mm256_load_pd(halfPrecisions + d);
+            __m256d scaledMean = _mm256_load_pd(scaledMeans + d);
+
+            for (unsigned int i = 0; i < 4; ++i)
+            {
+                __m256d x = _mm256_maskload_pd(frames[i] + d, mask);
+                __m256d t = _mm256_fnmadd_pd(x, halfPrecision, scaledMean);
+                sums[i] = _mm256_fmadd_pd(x, t, sums[i]);
+            }
+        }
+
+        // Horizontal sums of the four accumulators into one vector.
+        __m256d sum01 = _mm256_hadd_pd(sums[0], sums[1]);
+        __m256d sum23 = _mm256_hadd_pd(sums[2], sums[3]);
+
+        __m256d low = _mm256_permute2f128_pd(sum01, sum23, 0x20);
+        __m256d high = _mm256_permute2f128_pd(sum01, sum23, 0x31);
+
+        _mm256_storeu_pd(output, _mm256_add_pd(low, high));
+    }
+
+    inline void GetLinearTerms(const Real* const* frames, const Real* row, unsigned int dimensionCount, Real* output)
+    {
+        __m256d sums[4] = { _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd() };
+
+        for (unsigned int d = 0; d < dimensionCount; d += 4)
+        {
+            long long remaining = dimensionCount - d;
+
+            __m256i mask = _mm256_set_epi64x(remaining > 3 ? -1 : 0, remaining > 2 ? -1 : 0, remaining > 1 ? -1 : 0, -1);
+
+            __m256d values = _mm256_load_pd(row + d);
+
+            for (unsigned int i = 0; i < 4; ++i)
+            {
+                sums[i] = _mm256_fmadd_pd(_mm256_maskload_pd(frames[i] + d, mask), values, sums[i]);
+            }
+        }
+
+        __m256d sum01 = _mm256_hadd_pd(sums[0], sums[1]);
+        __m256d sum23 = _mm256_hadd_pd(sums[2], sums[3]);
+
+        __m256d low = _mm256_permute2f128_pd(sum01, sum23, 0x20);
+        __m256d high = _mm256_permute2f128_pd(sum01, sum23, 0x31);
+
+        _mm256_storeu_pd(output, _mm256_add_pd(low, high));
+    }
+#else
+    inline void GetQuadraticTerms(const Real* const* frames, const Real* halfPrecisions, const Real* scaledMeans,
+                                  unsigned int dimensionCount, Real* output)
+    {
+        for (unsigned int i = 0; i < MixtureKernel::BLOCK_FRAMES; ++i)
+        {
+            const Real* frame = frames[i];
+
+            Real sum = 0.0;
+
+            for (unsigned int d = 0; d < dimensionCount; ++d)
+            {
+                sum += frame[d] * (scaledMeans[d] - frame[d] * halfPrecisions[d]);
+            }
+
+            output[i] = sum;
+        }
+    }
+
+    inline void GetLinearTerms(const Real* const* frames, const Real* row, unsigned int dimensionCount, Real* output)
+    {
+        for (unsigned int i = 0; i < MixtureKernel::BLOCK_FRAMES; ++i)
+        {
+            const Real* frame = frames[i];
+
+            Real sum = 0.0;
+
+            for (unsigned int d = 0; d < dimensionCount; ++d)
+            {
+                sum += frame[d] * row[d];
+            }
+
+            output[i] = sum;
+        }
+    }
+#endif
+
+    /*! \brief Taylor coefficients 1/k! of exp around zero.
+     */
+    const Real EXP_COEFFICIENTS[] =
+    {
+        1.0, 1.0, 1.0 / 2.0, 1.0 / 6.0, 1.0 / 24.0, 1.0 / 120.0, 1.0 / 720.0, 1.0 / 5040.0,
+        1.0 / 40320.0, 1.0 / 362880.0, 1.0 / 3628800.0, 1.0 / 39916800.0
+    };
+
+    /*! \brief Polynomial degrees of the approximations.
+     *
+     *  After the reduction |r| <= log(2) / 2, so the relative error of degree
+     *  n is about (log(2) / 2)^(n + 1) / (n + 1)!.
+     */
+    const unsigned int HIGH_EXP_DEGREE = 11;
+    const unsigned int MEDIUM_EXP_DEGREE = 7;
+    const unsigned int LOW_EXP_DEGREE = 4;
+
+    const Real LOG2E = 1.4426950408889634;
+
+    /*! \brief log(2) split in two so that k * LN2_HIGH is exact.
+     */
+    const Real LN2_HIGH = 0.693145751953125;
+    const Real LN2_LOW = 1.42860682030941723212e-6;
+
+    /*! \brief The smallest argument whose exponent is a normal number.
+     */
+    const Real EXP_MINIMUM = -708.0;
+
+    /*! \brief Adding and subtracting 1.5 * 2^52 rounds a double to the nearest integer.
+     */
+    const Real ROUNDING_CONSTANT = 6755399441055744.0;
+
+    template<unsigned int DEGREE>
+    inline Real ApproximateExp(Real x)
+    {
+        x = Max(x, EXP_MINIMUM);
+
+        Real k = (x * LOG2E + ROUNDING_CONSTANT) - ROUNDING_CONSTANT;
+        Real r = (x - k * LN2_HIGH) - k * LN2_LOW;
+
+        Real p = EXP_COEFFICIENTS[DEGREE];
+
+        for (unsigned int i = DEGREE; i > 0; --i)
+        {
+            p = p * r + EXP_COEFFICIENTS[i - 1];
+        }
+
+        // 2^k built from the exponent bits.
+        std::uint64_t bits = static_cast<std::uint64_t>(static_cast<std::int64_t>(k) + 1023) << 52;
+
+        Real scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+
+        return p * scale;
+    }
+
+#if defined(__AVX512F__)
+    template<unsigned int DEGREE>
+    inline __m512d ApproximateExp(__m512d x)
+    {
+        x = _mm512_max_pd(x, _mm512_set1_pd(EXP_MINIMUM));
+
+        __m512d k = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512d r = _mm512_fnmadd_pd(k, _mm512_set1_pd(LN2_LOW), _mm512_fnmadd_pd(k, _mm512_set1_pd(LN2_HIGH), x));
+
+        __m512d p = _mm512_set1_pd(EXP_COEFFICIENTS[DEGREE]);
+
+        for (unsigned int i = DEGREE; i > 0; --i)
+        {
+            p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(EXP_COEFFICIENTS[i - 1]));
+        }
+
+        return _mm512_scalef_pd(p, k);
+    }
+
+    template<unsigned int DEGREE>
+    void ApproximateExp(Real* values, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i += 8)
+        {
+            __mmask8 mask = (count - i >= 8) ? 0xFF : static_cast<__mmask8>((1u << (count - i)) - 1);
+
+            _mm512_mask_storeu_pd(values + i, mask, ApproximateExp<DEGREE>(_mm512_maskz_loadu_pd(mask, values + i)));
+        }
+    }
+
+    template<unsigned int DEGREE>
+    Real ApproximateSumExp(const Real* values, unsigned int count, Real offset)
+    {
+        __m512d sum = _mm512_setzero_pd();
+        __m512d shift = _mm512_set1_pd(offset);
+
+        for (unsigned int i = 0; i < count; i += 8)
+        {
+            __mmask8 mask = (count - i >= 8) ? 0xFF : static_cast<__mmask8>((1u << (count - i)) - 1);
+
+            __m512d x = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, values + i), shift);
+
+            sum = _mm512_mask_add_pd(sum, mask, sum, ApproximateExp<DEGREE>(x));
+        }
+
+        return _mm512_reduce_add_pd(sum);
+    }
+#elif defined(__AVX2__) && defined(__FMA__)
+    template<unsigned int DEGREE>
+    inline __m256d ApproximateExp(__m256d x)
+    {
+        x = _mm256_max_pd(x, _mm256_set1_pd(EXP_MINIMUM));
+
+        __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(LN2_LOW), _mm256_fnmadd_pd(k, _mm256_set1_pd(LN2_HIGH), x));
+
+        __m256d p = _mm256_set1_pd(EXP_COEFFICIENTS[DEGREE]);
+
+        for (unsigned int i = DEGREE; i > 0; --i)
+        {
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(EXP_COEFFICIENTS[i - 1]));
+        }
+
+        // 2^k built from the exponent bits.
+        __m256i exponents = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k));
+        __m256i bits = _mm256_slli_epi64(_mm256_add_epi64(exponents, _mm256_set1_epi64x(1023)), 52);
+
+        return _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+    }
+
+    template<unsigned int DEGREE>
+    void ApproximateExp(Real* values, unsigned int count)
+    {
+        unsigned int i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm256_storeu_pd(values + i, ApproximateExp<DEGREE>(_mm256_loadu_pd(values + i)));
+        }
+
+        for (; i < count; ++i)
+        {
+            values[i] = ApproximateExp<DEGREE>(values[i]);
+        }
+    }
+
+    template<unsigned int DEGREE>
+    Real ApproximateSumExp(const Real* values, unsigned int count, Real offset)
+    {
+        __m256d sum = _mm256_setzero_pd();
+        __m256d shift = _mm256_set1_pd(offset);
+
+        unsigned int i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            sum = _mm256_add_pd(sum, ApproximateExp<DEGREE>(_mm256_sub_pd(_mm256_loadu_pd(values + i), shift)));
+        }
+
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+
+        Real result = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+
+        for (; i < count; ++i)
+        {
+            result += ApproximateExp<DEGREE>(values[i] - offset);
+        }
+
+        return result;
+    }
+#else
+    template<unsigned int DEGREE>
+    void ApproximateExp(Real* values, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            values[i] = ApproximateExp<DEGREE>(values[i]);
+        }
+    }
+
+    template<unsigned int DEGREE>
+    Real ApproximateSumExp(const Real* values, unsigned int count, Real offset)
+    {
+        Real sum = 0.0;
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            sum += ApproximateExp<DEGREE>(values[i] - offset);
+        }
+
+        return sum;
+    }
+#endif
+
+    /*! \brief Returns sum(exp(values - offset)).
+     */
+    Real SumExp(const Real* values, unsigned int count, Real offset, ExpAccuracy accuracy)
+    {
+        switch (accuracy)
+        {
+        case ExpAccuracy::HIGH:
+            return ApproximateSumExp<HIGH_EXP_DEGREE>(values, count, offset);
+        case ExpAccuracy::MEDIUM:
+            return ApproximateSumExp<MEDIUM_EXP_DEGREE>(values, count, offset);
+        case ExpAccuracy::LOW:
+            return ApproximateSumExp<LOW_EXP_DEGREE>(values, count, offset);
+        default:
+            break;
+        }
+
+        Real sum = 0.0;
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            sum += std::exp(values[i] - offset);
+        }
+
+        return sum;
+    }
+
+    Real GetMaximum(const Real* values, unsigned int count)
+    {
+        Real maximum = -std::numeric_limits<Real>::infinity();
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            maximum = Max(maximum, values[i]);
+        }
+
+        return maximum;
+    }
+}
+
+MixtureKernel::MixtureKernel()
+    : mComponentCount(0),
+    mDimensionCount(0),
+    mStride(0),
+    mExpAccuracy(ExpAccuracy::EXACT),
+    mExpTolerance(0.0)
+{
+
+}
+
+MixtureKernel::~MixtureKernel()
+{
+
+}
+
+void MixtureKernel::Resize(unsigned int componentCount, unsigned int dimensionCount)
+{
+    mComponentCount = componentCount;
+    mDimensionCount = dimensionCount;
+    mStride = GetPaddedSize(dimensionCount);
+
+    mHalfPrecisions.assign(static_cast<std::size_t>(componentCount) * mStride, 0.0);
+    mScaledMeans.assign(static_cast<std::size_t>(componentCount) * mStride, 0.0);
+    mConstants.assign(componentCount, -std::numeric_limits<Real>::infinity());
+}
+
+unsigned int MixtureKernel::GetComponentCount() const
+{
+    return mComponentCount;
+}
+
+unsigned int MixtureKernel::GetDimensionCount() const
+{
+    return mDimensionCount;
+}
+
+void MixtureKernel::SetExpAccuracy(ExpAccuracy accuracy)
+{
+    mExpAccuracy = accuracy;
+}
+
+ExpAccuracy MixtureKernel::GetExpAccuracy() const
+{
+    return mExpAccuracy;
+}
+
+void MixtureKernel::SetExpTolerance(Real tolerance)
+{
+    mExpTolerance = tolerance;
+}
+
+Real MixtureKernel::GetExpTolerance() const
+{
+    return mExpTolerance;
+}
+
+void MixtureKernel::SetComponent(unsigned int component, const Real* means, const Real* variances, Real weight)
+{
+    assert(component < mComponentCount);
+
+    Real* halfPrecisions = &mHalfPrecisions[static_cast<std::size_t>(component) * mStride];
+    Real* scaledMeans = &mScaledMeans[static_cast<std::size_t>(component) * mStride];
+
+    // Same as GMModel::UpdatePDF().
+    Real determinant = 1.0;
+    Real meanTerm = 0.0;
+
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        Real precision = 1.0 / variances[d];
+
+        halfPrecisions[d] = 0.5 * precision;
+        scaledMeans[d] = means[d] * precision;
+
+        determinant *= variances[d];
+        meanTerm += means[d] * means[d] * precision;
+    }
+
+    Real pdfConstant = -0.5 * (std::log(determinant) + static_cast<Real>(mDimensionCount) * std::log(2.0f * PI_F));
+
+    mConstants[component] = std::log(weight) + pdfConstant - 0.5 * meanTerm;
+}
+
+unsigned int MixtureKernel::GetPaddedSize(unsigned int dimensionCount)
+{
+    return (dimensionCount + KERNEL_PADDING - 1) / KERNEL_PADDING * KERNEL_PADDING;
+}
+
+void MixtureKernel::GetDotProducts(const FrameView& samples, unsigned int begin, unsigned int end,
+                                   const Real* rows, unsigned int rowCount, unsigned int rowStride, Real* output)
+{
+    const Real* frames[BLOCK_FRAMES];
+    Real terms[BLOCK_FRAMES];
+
+    for (unsigned int blockBegin = begin; blockBegin < end; blockBegin += BLOCK_FRAMES)
+    {
+        unsigned int blockSize = (end - blockBegin < BLOCK_FRAMES) ? end - blockBegin : BLOCK_FRAMES;
+
+        for (unsigned int i = 0; i < BLOCK_FRAMES; ++i)
+        {
+            frames[i] = samples[blockBegin + Min(i, blockSize - 1)];
+        }
+
+        Real* products = output + static_cast<std::size_t>(blockBegin - begin) * rowCount;
+
+        for (unsigned int r = 0; r < rowCount; ++r)
+        {
+            GetLinearTerms(frames, rows + static_cast<std::size_t>(r) * rowStride, samples.GetDimensionCount(), terms);
+
+            for (unsigned int i = 0; i < blockSize; ++i)
+            {
+                products[i * rowCount + r] = terms[i];
+            }
+        }
+    }
+}
+
+void MixtureKernel::GetLogLikelihoods(const FrameView& samples, unsigned int begin, unsigned int end, Real* output) const
+{
+    assert(samples.GetDimensionCount() == mDimensionCount);
+
+    const Real* frames[BLOCK_FRAMES];
+    Real terms[BLOCK_FRAMES];
+
+    for (unsigned int blockBegin = begin; blockBegin < end; blockBegin += BLOCK_FRAMES)
+    {
+        unsigned int blockSize = (end - blockBegin < BLOCK_FRAMES) ? end - blockBegin : BLOCK_FRAMES;
+
+        // A partial block repeats its last frame, the extra results are discarded.
+        for (unsigned int i = 0; i < BLOCK_FRAMES; ++i)
+        {
+            frames[i] = samples[blockBegin + Min(i, blockSize - 1)];
+        }
+
+        Real* rows = output + static_cast<std::size_t>(blockBegin - begin) * mComponentCount;
+
+        for (unsigned int c = 0; c < mComponentCount; ++c)
+        {
+            std::size_t offset = static_cast<std::size_t>(c) * mStride;
+
+            GetQuadraticTerms(frames, &mHalfPrecisions[offset], &mScaledMeans[offset], mDimensionCount, terms);
+
+            for (unsigned int i = 0; i < blockSize; ++i)
+            {
+                rows[i * mComponentCount + c] = mConstants[c] + terms[i];
+            }
+        }
+    }
+}
+
+Real MixtureKernel::GetLogLikelihood(const FrameView& samples) const
+{
+    std::vector<Real> buffer;
+
+    std::size_t mismatches = 0;
+
+    Real result = GetLogLikelihood(samples, buffer, mismatches);
+
+    ReportMismatches(mismatches);
+
+    return result;
+}
+
+Real MixtureKernel::GetLogLikelihood(const FrameView& samples, std::vector<Real>& buffer, std::size_t& mismatches) const
+{
+    if (samples.GetFrameCount() == 0 || mComponentCount == 0)
+    {
+        return 0.0;
+    }
+
+    buffer.resize(static_cast<std::size_t>(BUFFER_FRAMES) * mComponentCount);
+
+    Real result = 0.0;
+    Real invN = 1.0 / static_cast<Real>(samples.GetFrameCount());
+
+    for (unsigned int begin = 0; begin < samples.GetFrameCount(); begin += BUFFER_FRAMES)
+    {
+        unsigned int end = Min(begin + BUFFER_FRAMES, samples.GetFrameCount());
+
+        GetLogLikelihoods(samples, begin, end, buffer.data());
+
+        for (unsigned int n = begin; n < end; ++n)
+        {
+            result += GetLogSumExp(&buffer[static_cast<std::size_t>(n - begin) * mComponentCount], mComponentCount, mismatches) * invN;
+        }
+    }
+
+    return result;
+}
+
+Real MixtureKernel::GetLogLikelihood(const Real* frame, unsigned int component) const
+{
+    std::size_t offset = static_cast<std::size_t>(component) * mStride;
+
+    const Real* halfPrecisions = &mHalfPrecisions[offset];
+    const Real* scaledMeans = &mScaledMeans[offset];
+
+    Real sum = 0.0;
+
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        sum += frame[d] * (scaledMeans[d] - frame[d] * halfPrecisions[d]);
+    }
+
+    return mConstants[component] + sum;
+}
+
+Real MixtureKernel::SelectTopComponents(const FrameView& samples, unsigned int topCount,
+                                        std::vector<unsigned int>& components, std::vector<Real>& buffer,
+                                        std::size_t& mismatches) const
+{
+    topCount = Min(topCount, mComponentCount);
+
+    components.resize(static_cast<std::size_t>(samples.GetFrameCount()) * topCount);
+
+    if (samples.GetFrameCount() == 0 || topCount == 0)
+    {
+        return 0.0;
+    }
+
+    buffer.resize(static_cast<std::size_t>(BUFFER_FRAMES) * mComponentCount);
+
+    Real result = 0.0;
+    Real invN = 1.0 / static_cast<Real>(samples.GetFrameCount());
+
+    for (unsigned int begin = 0; begin < samples.GetFrameCount(); begin += BUFFER_FRAMES)
+    {
+        unsigned int end = Min(begin + BUFFER_FRAMES, samples.GetFrameCount());
+
+        GetLogLikelihoods(samples, begin, end, buffer.data());
+
+        for (unsigned int n = begin; n < end; ++n)
+        {
+            const Real* row = &buffer[static_cast<std::size_t>(n - begin) * mComponentCount];
+            unsigned int* top = &components[static_cast<std::size_t>(n) * topCount];
+
+            // Insertion into a short sorted list, topCount is small.
+            unsigned int selected = 0;
+
+            for (unsigned int c = 0; c < mComponentCount; ++c)
+            {
+                if (selected == topCount && row[c] <= row[top[topCount - 1]])
+                {
+                    continue;
+                }
+
+                unsigned int i = (selected < topCount) ? selected++ : topCount - 1;
+
+                while (i > 0 && row[top[i - 1]] < row[c])
+                {
+                    top[i] = top[i - 1];
+                    --i;
+                }
+
+                top[i] = c;
+            }
+
+            result += GetLogSumExp(row, mComponentCount, mismatches) * invN;
+        }
+    }
+
+    return result;
+}
+
+Real MixtureKernel::GetLogLikelihood(const FrameView& samples, const std::vector<unsigned int>& components, unsigned int topCount,
+                                     std::size_t& mismatches) const
+{
+    topCount = Min(topCount, mComponentCount);
+
+    if (samples.GetFrameCount() == 0 || topCount == 0)
+    {
+        return 0.0;
+    }
+
+    assert(components.size() >= static_cast<std::size_t>(samples.GetFrameCount()) * topCount);
+
+    std::vector<Real> values(topCount);
+
+    Real result = 0.0;
+    Real invN = 1.0 / static_cast<Real>(samples.GetFrameCount());
+
+    for (unsigned int n = 0; n < samples.GetFrameCount(); ++n)
+    {
+        const unsigned int* top = &components[static_cast<std::size_t>(n) * topCount];
+
+        for (unsigned int i = 0; i < topCount; ++i)
+        {
+            values[i] = GetLogLikelihood(samples[n], top[i]);
+        }
+
+        // The same accuracy as SelectTopComponents(), so that the ratios are not biased.
+        result += GetLogSumExp(values.data(), topCount, mismatches) * invN;
+    }
+
+    return result;
+}
+
+Real MixtureKernel::GetLogSumExp(const Real* values, unsigned int count, std::size_t& mismatches) const
+{
+    if (mExpAccuracy == ExpAccuracy::EXACT)
+    {
+        return LogSumExp(values, count);
+    }
+
+    Real maximum = GetMaximum(values, count);
+
+    if (maximum == -std::numeric_limits<Real>::infinity())
+    {
+        return maximum;
+    }
+
+    Real result = maximum + std::log(SumExp(values, count, maximum, mExpAccuracy));
+
+    if (mExpTolerance > 0.0)
+    {
+        Real exact = LogSumExp(values, count);
+
+        if (std::abs(result - exact) > mExpTolerance)
+        {
+            ++mismatches;
+
+            return exact;
+        }
+    }
+
+    return result;
+}
+
+unsigned int MixtureKernel::GetPosteriors(const Real* values, unsigned int count, Real threshold,
+                                          Real* posteriors, unsigned int* components, Real& logSumExp,
+                                          std::size_t& mismatches) const
+{
+    logSumExp = GetLogSumExp(values, count, mismatches);
+
+    // Comparing in the log domain avoids exp for the skipped components.
+    Real logThreshold = (threshold > 0.0) ? std::log(threshold) : -std::numeric_limits<Real>::infinity();
+
+    unsigned int selected = 0;
+
+    for (unsigned int c = 0; c < count; ++c)
+    {
+        Real logPosterior = values[c] - logSumExp;
+
+        if (logPosterior >= logThreshold)
+        {
+            posteriors[selected] = logPosterior;
+            components[selected] = c;
+            ++selected;
+        }
+    }
+
+    Exp(posteriors, selected, mExpAccuracy);
+
+    if (mExpTolerance > 0.0 && mExpAccuracy != ExpAccuracy::EXACT)
+    {
+        for (unsigned int i = 0; i < selected; ++i)
+        {
+            Real exact = std::exp(values[components[i]] - logSumExp);
+
+            if (std::abs(posteriors[i] - exact) > mExpTolerance)
+            {
+                posteriors[i] = exact;
+                ++mismatches;
+            }
+        }
+    }
+
+    return selected;
+}
+
+void MixtureKernel::ReportMismatches(std::size_t mismatches)
+{
+    if (mismatches > 0)
+    {
+        std::cout << "Warning: " << mismatches << " approximated exp values differed from exact and were replaced." << std::endl;
+    }
+}
+
+Real MixtureKernel::LogSumExp(const Real* values, unsigned int count)
+{
+    Real maximum = GetMaximum(values, count);
+
+    if (maximum == -std::numeric_limits<Real>::infinity())
+    {
+        return maximum;
+    }
+
+    return maximum + std::log(SumExp(values, count, maximum, ExpAccuracy::EXACT));
+}
+
+void MixtureKernel::Exp(Real* values, unsigned int count, ExpAccuracy accuracy)
+{
+    switch (accuracy)
+    {
+    case ExpAccuracy::HIGH:
+        ApproximateExp<HIGH_EXP_DEGREE>(values, count);
+        break;
+    case ExpAccuracy::MEDIUM:
+        ApproximateExp<MEDIUM_EXP_DEGREE>(values, count);
+        break;
+    case ExpAccuracy::LOW:
+        ApproximateExp<LOW_EXP_DEGREE>(values, count);
+        break;
+    default:
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            values[i] = std::exp(values[i]);
+        }
+        break;
+    }
+}
+
+const char* MixtureKernel::GetInstructionSet()
+{
+#if defined(__AVX512F__)
+    return "AVX-512";
+#elif defined(__AVX2__) && defined(__FMA__)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
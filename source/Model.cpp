@@ -1,7 +1,9 @@
 #include "Model.h"
 
 Model::Model()
-: mOrder(128)
+: mOrder(128),
+  mThreadCount(1),
+  mProgressEnabled(true)
 {
 
 }
@@ -20,4 +22,56 @@ unsigned int Model::GetOrder() const
 {
     return mOrder;
 }
- 
\ No newline at end of file
+
+void Model::SetThreadCount(unsigned int threadCount)
+{
+    mThreadCount = threadCount;
+}
+
+unsigned int Model::GetThreadCount() const
+{
+    return mThreadCount;
+}
+
+void Model::SetProgressEnabled(bool enabled)
+{
+    mProgressEnabled = enabled;
+}
+
+bool Model::IsProgressEnabled() const
+{
+    return mProgressEnabled;
+}
+
+void Model::PrintIteration() const
+{
+    if (mProgressEnabled)
+    {
+        std::cout << ".";
+    }
+}
+
+void Model::EndIterations() const
+{
+    if (mProgressEnabled)
+    {
+        std::cout << std::endl;
+    }
+}
+
+Real Model::GetScore(const FrameView& samples) const
+{
+    return GetScore(samples, GetThreadWorkspace());
+}
+
+Real Model::GetLogScore(const FrameView& samples) const
+{
+    return GetLogScore(samples, GetThreadWorkspace());
+}
+
+ScoringWorkspace& Model::GetThreadWorkspace()
+{
+    thread_local ScoringWorkspace workspace;
+
+    return workspace;
+}
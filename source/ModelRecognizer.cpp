@@ -1,5 +1,66 @@
 #include "ModelRecognizer.h"
 
+#include "ThreadPool.h"
+
+namespace
+{
+    /*! \brief Groups speakers into training tasks of a similar number of frames.
+     *
+     *  A speaker with at least 1 / threadCount of all frames is a task of its
+     *  own and is marked to split its frames across the threads. The other
+     *  speakers are packed in order into tasks of about 1 / (4 * threadCount)
+     *  of all frames, so that the threads finish at about the same time.
+     */
+    std::vector<std::vector<unsigned int> > PackSpeakers(const std::vector<FrameView>& frames, unsigned int threadCount,
+                                                        std::vector<bool>& split)
+    {
+        std::size_t totalFrameCount = 0;
+
+        for (const auto& speaker : frames)
+        {
+            totalFrameCount += speaker.GetFrameCount();
+        }
+
+        std::size_t taskFrameCount = Max(totalFrameCount / (4 * threadCount), static_cast<std::size_t>(1));
+
+        std::vector<std::vector<unsigned int> > tasks;
+        std::vector<unsigned int> task;
+
+        std::size_t frameCount = 0;
+
+        split.assign(frames.size(), false);
+
+        for (unsigned int i = 0; i < frames.size(); ++i)
+        {
+            std::size_t speakerFrameCount = frames[i].GetFrameCount();
+
+            if (speakerFrameCount * threadCount >= totalFrameCount)
+            {
+                split[i] = true;
+                tasks.push_back({i});
+                continue;
+            }
+
+            task.push_back(i);
+            frameCount += speakerFrameCount;
+
+            if (frameCount >= taskFrameCount)
+            {
+                tasks.push_back(task);
+                task.clear();
+                frameCount = 0;
+            }
+        }
+
+        if (!task.empty())
+        {
+            tasks.push_back(task);
+        }
+
+        return tasks;
+    }
+}
+
 ModelRecognizer::ModelRecognizer()
 :   mOrder(128),
     mAdaptationIterations(2),
@@ -10,6 +71,7 @@ ModelRecognizer::ModelRecognizer()
     mPrepared(false),
     mTrainingIterations(15),
     mEta(0.001f),
+    mThreadCount(1),
     mBackgroundModelDirty(true),
     mAdaptationEnabled(false),
     mSpeakerModelsDirty(true),
@@ -28,6 +90,7 @@ void ModelRecognizer::ClearTrainedData()
 {
     mPrepared = false;
     mModelCache.clear();
+    mRelevanceModelCaches.clear();
     mSpeakerModels.clear();
     mImpostorDistributions.clear();
     mImpostorModels.clear();
@@ -85,7 +148,18 @@ void ModelRecognizer::SetRelevanceFactor(Real factor)
 {
     if (std::abs(factor - mRelevanceFactor) > 0.0005f)
     {
-        mSpeakerModelsDirty = true;
+        auto it = FindRelevanceModelCache(factor);
+
+        // Swept models are only valid until something else changes.
+        if (it != mRelevanceModelCaches.end() && !mSpeakerModelsDirty)
+        {
+            SelectModelCache(it->second);
+        }
+
+        else
+        {
+            mSpeakerModelsDirty = true;
+        }
     }
 
     mRelevanceFactor = factor;
@@ -96,6 +170,68 @@ Real ModelRecognizer::GetRelevanceFactor() const
     return mRelevanceFactor;
 }
 
+void ModelRecognizer::SetRelevanceFactors(const std::vector<Real>& factors)
+{
+    if (factors == mRelevanceFactors)
+    {
+        return;
+    }
+
+    // The current models remain valid without a sweep.
+    if (!factors.empty())
+    {
+        mSpeakerModelsDirty = true;
+    }
+
+    mRelevanceModelCaches.clear();
+    mRelevanceFactors = factors;
+}
+
+const std::vector<Real>& ModelRecognizer::GetRelevanceFactors() const
+{
+    return mRelevanceFactors;
+}
+
+std::map<Real, ModelRecognizer::ModelCache>::iterator ModelRecognizer::FindRelevanceModelCache(Real factor)
+{
+    auto it = mRelevanceModelCaches.lower_bound(factor - 0.0005f);
+
+    if (it != mRelevanceModelCaches.end() && it->first <= factor + 0.0005f)
+    {
+        return it;
+    }
+
+    return mRelevanceModelCaches.end();
+}
+
+void ModelRecognizer::SelectModelCache(const ModelCache& cache)
+{
+    mModelCache = cache;
+
+    for (auto& model : mSpeakerModels)
+    {
+        auto it = mModelCache.find(model.first);
+
+        if (it != mModelCache.end())
+        {
+            model.second = it->second;
+        }
+    }
+
+    for (auto& model : mImpostorModels)
+    {
+        auto it = mModelCache.find(model.first);
+
+        if (it != mModelCache.end())
+        {
+            model.second = it->second;
+        }
+    }
+
+    mImpostorDistributions.clear();
+    Unprepare();
+}
+
 void ModelRecognizer::SetScoreNormalizationType(ScoreNormalizationType type)
 {
     if (type != mScoreNormalizationType)
@@ -146,6 +282,11 @@ void ModelRecognizer::Unprepare()
     mPrepared = false;
 }
 
+void ModelRecognizer::SetSpeakerModelsDirty()
+{
+    mSpeakerModelsDirty = true;
+}
+
 void ModelRecognizer::PrepareModels()
 {
     // Virtual
@@ -168,25 +309,30 @@ std::shared_ptr<SpeechData> ModelRecognizer::GetBackgroundModelData()
 
 void ModelRecognizer::TrainBackgroundModel()
 {
-    mBackgroundModel = CreateModel();
+    mBackgroundModel = CreateBackgroundModel();
+
+    FrameMatrix samples(mBackgroundModelData->GetDimensionCount());
 
-    std::vector< DynamicVector<Real> > samples;
+    samples.Reserve(mBackgroundModelData->GetTotalSampleCount());
         
     for (const auto& speaker : mBackgroundModelData->GetSamples())
     {
-        for (const auto& sample : speaker.second)
-        {
-            samples.push_back(sample);
-        }
+        samples.Append(speaker.second);
     }
 
     mBackgroundModel->SetOrder(GetOrder());
+    mBackgroundModel->SetThreadCount(mThreadCount);
 
     Timer timer;
     mBackgroundModel->Train(samples, GetTrainingIterations());
     mTrainTimeBackgroundModel = timer.GetTimeElapsed();
 }
 
+std::shared_ptr<Model> ModelRecognizer::CreateBackgroundModel()
+{
+    return CreateModel();
+}
+
 void ModelRecognizer::TrainSpeakerModels()
 {
     unsigned int progress = 0;
@@ -202,42 +348,163 @@ void ModelRecognizer::TrainSpeakerModels()
     {
         std::cout << "Warning: enabled background model not found." << std::endl;
     }
-    
-    Timer timer;
-    for (const auto& sequence : mSpeakerData->GetSamples())
+
+    mRelevanceModelCaches.clear();
+
+    // Sweep the current relevance factor too, its models are selected below.
+    std::vector<Real> factors;
+
+    if (adapt && !mRelevanceFactors.empty())
     {
-        ++progress;
+        factors = mRelevanceFactors;
 
-        auto model = CreateModel();
-        mModelCache[sequence.first] = model;
+        bool found = false;
 
-        if (adapt)
+        for (Real factor : factors)
         {
-            std::cout << "Training model (MAP): " << sequence.first
-                << " (" << 100 * progress / mSpeakerData->GetSamples().size() << "%)" << std::endl;
+            if (std::abs(factor - mRelevanceFactor) <= 0.0005f)
+            {
+                found = true;
+            }
         }
 
-        else
+        if (!found)
         {
-            std::cout << "Training model: " << sequence.first
-                << " (" << 100 * progress / mSpeakerData->GetSamples().size() << "%)" << std::endl;
+            factors.push_back(mRelevanceFactor);
         }
+    }
+    
+    std::vector<const SpeakerKey*> speakers;
+    std::vector<FrameView> frames;
 
-        // UBM exists, train everything else with adaptation.
-        if (adapt)
+    for (const auto& sequence : mSpeakerData->GetSamples())
+    {
+        speakers.push_back(&sequence.first);
+        frames.push_back(sequence.second);
+    }
+
+    unsigned int threadCount = (mThreadCount > 0) ? mThreadCount : ThreadPool::GetDefault().GetThreadCount();
+
+    std::vector<bool> split;
+    std::vector<std::vector<unsigned int> > tasks = PackSpeakers(frames, threadCount, split);
+
+    // Models are created up front, the model caches are not thread safe.
+    std::vector<std::vector<std::shared_ptr<Model> > > models(speakers.size());
+
+    // Only the locked progress lines are printed while tasks run concurrently.
+    bool progressEnabled = threadCount <= 1 || tasks.size() <= 1;
+
+    for (unsigned int i = 0; i < speakers.size(); ++i)
+    {
+        // Large speakers split their frames, packed speakers are trained on a single thread.
+        unsigned int modelThreadCount = split[i] ? mThreadCount : 1;
+
+        if (!factors.empty())
         {
-            model->Adapt(mBackgroundModel, sequence.second, mAdaptationIterations, mRelevanceFactor);
+            for (Real factor : factors)
+            {
+                auto model = CreateModel();
+                model->SetThreadCount(modelThreadCount);
+                model->SetProgressEnabled(progressEnabled);
+                mRelevanceModelCaches[factor][*speakers[i]] = model;
+
+                models[i].push_back(model);
+            }
+
+            continue;
         }
 
-        // No UBM, train normally.
-        else
+        auto model = CreateModel();
+        model->SetThreadCount(modelThreadCount);
+        model->SetProgressEnabled(progressEnabled);
+        mModelCache[*speakers[i]] = model;
+
+        models[i].push_back(model);
+    }
+
+    std::mutex progressMutex;
+
+    auto trainTask = [&](unsigned int t) {
+        for (unsigned int i : tasks[t])
         {
-            model->SetOrder(GetOrder());
+            {
+                std::lock_guard<std::mutex> lock(progressMutex);
+
+                ++progress;
+
+                if (!factors.empty())
+                {
+                    std::cout << "Training models (MAP, " << factors.size() << " relevance factors): " << *speakers[i]
+                        << " (" << 100 * progress / speakers.size() << "%)" << std::endl;
+                }
+
+                else if (adapt)
+                {
+                    std::cout << "Training model (MAP): " << *speakers[i]
+                        << " (" << 100 * progress / speakers.size() << "%)" << std::endl;
+                }
+
+                else
+                {
+                    std::cout << "Training model: " << *speakers[i]
+                        << " (" << 100 * progress / speakers.size() << "%)" << std::endl;
+                }
+            }
 
-            model->Train(sequence.second, GetTrainingIterations());
+            if (!factors.empty())
+            {
+                AdaptModels(models[i], *speakers[i], frames[i], factors);
+            }
+
+            // UBM exists, train everything else with adaptation.
+            else if (adapt)
+            {
+                AdaptModel(models[i][0], *speakers[i], frames[i]);
+            }
+
+            // No UBM, train normally.
+            else
+            {
+                models[i][0]->SetOrder(GetOrder());
+
+                models[i][0]->Train(frames[i], GetTrainingIterations());
+            }
+        }
+    };
+
+    Timer timer;
+    if (threadCount > 1)
+    {
+        ThreadPool::GetDefault().ParallelFor(tasks.size(), trainTask);
+    }
+
+    else
+    {
+        for (unsigned int t = 0; t < tasks.size(); ++t)
+        {
+            trainTask(t);
         }
     }
     mTrainTimeSpeakerModels = timer.GetTimeElapsed();
+
+    if (!factors.empty())
+    {
+        SelectModelCache(FindRelevanceModelCache(mRelevanceFactor)->second);
+    }
+}
+
+void ModelRecognizer::AdaptModel(const std::shared_ptr<Model>& model, const SpeakerKey& /*speaker*/, const FrameView& samples)
+{
+    model->Adapt(mBackgroundModel, samples, mAdaptationIterations, mRelevanceFactor);
+}
+
+void ModelRecognizer::AdaptModels(const std::vector<std::shared_ptr<Model> >& models, const SpeakerKey& /*speaker*/,
+                                  const FrameView& samples, const std::vector<Real>& factors)
+{
+    for (unsigned int i = 0; i < models.size(); ++i)
+    {
+        models[i]->Adapt(mBackgroundModel, samples, mAdaptationIterations, factors[i]);
+    }
 }
 
 void ModelRecognizer::Train()
@@ -466,6 +733,15 @@ void ModelRecognizer::Test(const std::shared_ptr<SpeechData>& data, std::map<Spe
     // Clear old results (if any).
     results.clear();
 
+    std::vector<SpeakerKey> speakers;
+    std::vector<std::shared_ptr<Model> > models;
+
+    for (auto& model : mSpeakerModels)
+    {
+        speakers.push_back(model.first);
+        models.push_back(model.second);
+    }
+
     for (auto& entry : data->GetSamples())
     {
         SpeakerKey bestModelName;
@@ -473,38 +749,53 @@ void ModelRecognizer::Test(const std::shared_ptr<SpeechData>& data, std::map<Spe
 
         bool knownSpeaker = false;
         Real bestModelScore = std::numeric_limits<Real>::min();
+        Real bestModelLogScore = 0.0f;
 
-        for (auto& model : mSpeakerModels)
+        // Do not confuse these!
+        std::vector<Real> modelLogScores = GetLogScores(models, entry.second);
+        std::vector<Real> modelScores(models.size());
+
+        // Model::GetScore() is the exponent of Model::GetLogScore().
+        for (unsigned int m = 0; m < models.size(); ++m)
         {
-            if (entry.first.IsSameSpeaker(model.first))
-            {
-                knownSpeaker = true;
-            }
+            modelScores[m] = std::exp(modelLogScores[m]);
+        }
 
-            // Do not confuse these!
-            Real modelScore = model.second->GetScore(entry.second);
-            Real modelLogScore = model.second->GetLogScore(entry.second);
+        Real backgroundLogScore = 0.0f;
 
-            // Notice logarithmic domain.
-            Real ubmLogScore = std::numeric_limits<Real>::max();
+        if (mBackgroundModel != nullptr)
+        {
+            backgroundLogScore = mBackgroundModel->GetLogScore(entry.second);
+        }
 
-            if (mBackgroundModel != nullptr && mBackgroundModelEnabled)
+        // Notice logarithmic domain.
+        Real ubmLogScore = std::numeric_limits<Real>::max();
+
+        if (mBackgroundModel != nullptr && mBackgroundModelEnabled)
+        {
+            ubmLogScore = backgroundLogScore;
+        }
+
+        for (unsigned int m = 0; m < models.size(); ++m)
+        {
+            if (entry.first.IsSameSpeaker(speakers[m]))
             {
-                ubmLogScore = mBackgroundModel->GetLogScore(entry.second);
+                knownSpeaker = true;
             }
 
-            std::cout << entry.first << "-" << model.first
-                << " m:" << modelScore
-                << ",l:" << modelLogScore
+            std::cout << entry.first << "-" << speakers[m]
+                << " m:" << modelScores[m]
+                << ",l:" << modelLogScores[m]
                 << ",u:" << ubmLogScore
-                << ",r:" << modelLogScore - ubmLogScore
-                << ",v:" << GetVerificationScore(model.first, entry.second) << std::endl;
+                << ",r:" << modelLogScores[m] - ubmLogScore
+                << ",v:" << GetVerificationScore(speakers[m], entry.second) << std::endl;
 
-            if (modelScore > bestModelScore)
+            if (modelScores[m] > bestModelScore)
             {
-                bestModelScore = modelScore;
-                bestModel = model.second;
-                bestModelName = model.first;
+                bestModelScore = modelScores[m];
+                bestModelLogScore = modelLogScores[m];
+                bestModel = models[m];
+                bestModelName = speakers[m];
             }
         }
 
@@ -516,7 +807,7 @@ void ModelRecognizer::Test(const std::shared_ptr<SpeechData>& data, std::map<Spe
             // and the model actually exists.
             if (mBackgroundModel != nullptr)
             {
-                Real logRatio = bestModel->GetLogScore(entry.second) - mBackgroundModel->GetLogScore(entry.second);
+                Real logRatio = bestModelLogScore - backgroundLogScore;
 
                 // UBM is not too close to bestMatch.
                 if (logRatio > 0.3f && bestModelScore >= 0.08f) // UBM Threshold
@@ -554,7 +845,7 @@ void ModelRecognizer::Test(const std::shared_ptr<SpeechData>& data, std::map<Spe
     }
 }
 
-Real ModelRecognizer::GetRatio(const std::shared_ptr<Model>& model, const std::vector< DynamicVector<Real> >& samples)
+Real ModelRecognizer::GetRatio(const std::shared_ptr<Model>& model, const FrameView& samples)
 {
     Train();
 
@@ -566,7 +857,43 @@ Real ModelRecognizer::GetRatio(const std::shared_ptr<Model>& model, const std::v
     return model->GetScore(samples);
 }
 
-bool ModelRecognizer::IsRecognized(const SpeakerKey& speaker, const std::vector< DynamicVector<Real> >& samples)
+std::vector<Real> ModelRecognizer::GetScores(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples)
+{
+    std::vector<Real> scores;
+
+    for (const auto& model : models)
+    {
+        scores.push_back(model->GetScore(samples));
+    }
+
+    return scores;
+}
+
+std::vector<Real> ModelRecognizer::GetLogScores(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples)
+{
+    std::vector<Real> logScores;
+
+    for (const auto& model : models)
+    {
+        logScores.push_back(model->GetLogScore(samples));
+    }
+
+    return logScores;
+}
+
+std::vector<Real> ModelRecognizer::GetRatios(const std::vector<std::shared_ptr<Model> >& models, const FrameView& samples)
+{
+    std::vector<Real> ratios;
+
+    for (const auto& model : models)
+    {
+        ratios.push_back(GetRatio(model, samples));
+    }
+
+    return ratios;
+}
+
+bool ModelRecognizer::IsRecognized(const SpeakerKey& speaker, const FrameView& samples)
 {
     Train();
 
@@ -586,24 +913,33 @@ bool ModelRecognizer::IsRecognized(const SpeakerKey& speaker, const std::vector<
         return false;
     }
 
+    std::vector<SpeakerKey> speakers;
+    std::vector<std::shared_ptr<Model> > models;
+
+    for (auto& model : mSpeakerModels)
+    {
+        speakers.push_back(model.first);
+        models.push_back(model.second);
+    }
+
+    std::vector<Real> scores = GetScores(models, samples);
+
     Real bestScore = std::numeric_limits<Real>::min();
     SpeakerKey bestSpeaker;
     
-    for (auto& model : mSpeakerModels)
+    for (unsigned int m = 0; m < models.size(); ++m)
     {
-        Real score = model.second->GetScore(samples);
-
-        if (score > bestScore)
+        if (scores[m] > bestScore)
         {
-            bestScore = score;
-            bestSpeaker = model.first;
+            bestScore = scores[m];
+            bestSpeaker = speakers[m];
         }
     }
 
     return bestSpeaker == speaker;
 }
 
-Real ModelRecognizer::GetVerificationScore(const SpeakerKey& speaker, const std::vector< DynamicVector<Real> >& samples)
+Real ModelRecognizer::GetVerificationScore(const SpeakerKey& speaker, const FrameView& samples)
 {
     Train();
 
@@ -642,9 +978,7 @@ Real ModelRecognizer::GetVerificationScore(const SpeakerKey& speaker, const std:
         || mScoreNormalizationType == ScoreNormalizationType::ZERO_TEST
         || mScoreNormalizationType == ScoreNormalizationType::TEST_ZERO)
     {
-        std::vector<Real> scores;
-
-        unsigned int impostors = 0;
+        std::vector<std::shared_ptr<Model> > models;
 
         for (auto& impostor : mImpostorModels)
         {
@@ -652,12 +986,14 @@ Real ModelRecognizer::GetVerificationScore(const SpeakerKey& speaker, const std:
             {
                 continue;
             }
-            
-            ++impostors;
 
-            scores.push_back(GetRatio(impostor.second, samples));
+            models.push_back(impostor.second);
         }
 
+        unsigned int impostors = models.size();
+
+        std::vector<Real> scores = GetRatios(models, samples);
+
         if (impostors > 1)
         {
             td.mean = Mean(scores);
@@ -824,4 +1160,14 @@ void ModelRecognizer::SetTrainingThreshold(Real threshold)
 Real ModelRecognizer::GetTrainingThreshold() const
 {
     return mEta;
-}
\ No newline at end of file
+}
+
+void ModelRecognizer::SetThreadCount(unsigned int threadCount)
+{
+    mThreadCount = threadCount;
+}
+
+unsigned int ModelRecognizer::GetThreadCount() const
+{
+    return mThreadCount;
+}
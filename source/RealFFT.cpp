@@ -0,0 +1,104 @@
+#include "RealFFT.h"
+
+RealFFT::RealFFT(unsigned int size)
+    : mSize(size)
+{
+    assert(size >= 2 && (size & (size - 1)) == 0);
+
+    unsigned int half = size / 2;
+
+    mBitReversal.resize(half);
+
+    for (unsigned int i = 0, j = 0; i < half; ++i)
+    {
+        mBitReversal[i] = j;
+
+        unsigned int bit = half >> 1;
+
+        while (bit > 0 && (j & bit))
+        {
+            j ^= bit;
+            bit >>= 1;
+        }
+
+        j |= bit;
+    }
+
+    mTwiddles.resize(half);
+
+    for (unsigned int k = 0; k < half; ++k)
+    {
+        Real angle = -2.0 * 3.14159265358979323846 * k / size;
+        mTwiddles[k] = std::complex<Real>(std::cos(angle), std::sin(angle));
+    }
+}
+
+RealFFT::~RealFFT()
+{
+
+}
+
+unsigned int RealFFT::GetSize() const
+{
+    return mSize;
+}
+
+void RealFFT::Transform(const Real* input, std::complex<Real>* output) const
+{
+    unsigned int half = mSize / 2;
+
+    // Pack even and odd values to the real and imaginary parts.
+    for (unsigned int i = 0; i < half; ++i)
+    {
+        unsigned int j = mBitReversal[i];
+        output[j] = std::complex<Real>(input[2 * i], input[2 * i + 1]);
+    }
+
+    // Iterative radix-2 transform of size N / 2, which uses every other twiddle factor of size N.
+    for (unsigned int length = 2; length <= half; length <<= 1)
+    {
+        unsigned int step = mSize / length;
+
+        for (unsigned int start = 0; start < half; start += length)
+        {
+            for (unsigned int k = 0; k < length / 2; ++k)
+            {
+                std::complex<Real> even = output[start + k];
+                std::complex<Real> odd = output[start + k + length / 2] * mTwiddles[k * step];
+
+                output[start + k] = even + odd;
+                output[start + k + length / 2] = even - odd;
+            }
+        }
+    }
+
+    // Separate the transforms of the even and odd values.
+    std::complex<Real> first = output[0];
+
+    output[0] = std::complex<Real>(first.real() + first.imag(), 0.0);
+    output[half] = std::complex<Real>(first.real() - first.imag(), 0.0);
+
+    for (unsigned int k = 1; k <= half / 2; ++k)
+    {
+        std::complex<Real> a = output[k];
+        std::complex<Real> b = std::conj(output[half - k]);
+
+        std::complex<Real> even = 0.5 * (a + b);
+        std::complex<Real> odd = std::complex<Real>(0.0, -0.5) * (a - b);
+
+        output[k] = even + mTwiddles[k] * odd;
+        output[half - k] = std::conj(even - mTwiddles[k] * odd);
+    }
+}
+
+void RealFFT::GetPowerSpectrum(const Real* input, Real* output) const
+{
+    std::vector<std::complex<Real> > spectrum(mSize / 2 + 1);
+
+    Transform(input, spectrum.data());
+
+    for (unsigned int k = 0; k <= mSize / 2; ++k)
+    {
+        output[k] = std::norm(spectrum[k]);
+    }
+}
@@ -0,0 +1,120 @@
+#include "SlidingWindowNormalizer.h"
+
+SlidingWindowNormalizer::SlidingWindowNormalizer(unsigned int dimensionCount, unsigned int windowSize)
+{
+    Reset(dimensionCount, windowSize);
+}
+
+SlidingWindowNormalizer::~SlidingWindowNormalizer()
+{
+
+}
+
+void SlidingWindowNormalizer::Reset()
+{
+    Reset(mDimensionCount, mWindowSize);
+}
+
+void SlidingWindowNormalizer::Reset(unsigned int dimensionCount, unsigned int windowSize)
+{
+    mDimensionCount = dimensionCount;
+    mWindowSize = Max(windowSize, 1u);
+    mFrameCount = 0;
+    mFirst = 0;
+    mRemovedCount = 0;
+
+    mWindow.assign(static_cast<std::size_t>(mWindowSize) * dimensionCount, 0.0);
+    mSums.assign(dimensionCount, 0.0);
+    mSquareSums.assign(dimensionCount, 0.0);
+}
+
+unsigned int SlidingWindowNormalizer::GetDimensionCount() const
+{
+    return mDimensionCount;
+}
+
+unsigned int SlidingWindowNormalizer::GetWindowSize() const
+{
+    return mWindowSize;
+}
+
+unsigned int SlidingWindowNormalizer::GetFrameCount() const
+{
+    return mFrameCount;
+}
+
+void SlidingWindowNormalizer::Normalize(Real* frame)
+{
+    Real* sums = mSums.data();
+    Real* squareSums = mSquareSums.data();
+
+    // Remove the oldest frame if the window is full.
+    if (mFrameCount == mWindowSize)
+    {
+        const Real* oldest = &mWindow[static_cast<std::size_t>(mFirst) * mDimensionCount];
+
+        for (unsigned int d = 0; d < mDimensionCount; ++d)
+        {
+            sums[d] -= oldest[d];
+            squareSums[d] -= oldest[d] * oldest[d];
+        }
+
+        mFirst = (mFirst + 1) % mWindowSize;
+        --mFrameCount;
+        ++mRemovedCount;
+    }
+
+    Real* newest = &mWindow[static_cast<std::size_t>((mFirst + mFrameCount) % mWindowSize) * mDimensionCount];
+
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        newest[d] = frame[d];
+        sums[d] += frame[d];
+        squareSums[d] += frame[d] * frame[d];
+    }
+
+    ++mFrameCount;
+
+    // Subtracting removed frames accumulates rounding errors, recomputing
+    // once per window keeps the cost amortized O(1).
+    if (mRemovedCount >= mWindowSize)
+    {
+        UpdateSums();
+    }
+
+    Real invCount = 1.0 / mFrameCount;
+    Real invVarianceCount = (mFrameCount > 1) ? 1.0 / (mFrameCount - 1) : 0.0;
+
+    for (unsigned int d = 0; d < mDimensionCount; ++d)
+    {
+        Real mean = sums[d] * invCount;
+        Real variance = (squareSums[d] - sums[d] * mean) * invVarianceCount;
+
+        frame[d] -= mean;
+
+        // Variances at the rounding error level of the sums are treated as zero.
+        if (variance > std::numeric_limits<Real>::epsilon() * squareSums[d] * invCount)
+        {
+            frame[d] /= std::sqrt(variance);
+        }
+    }
+}
+
+void SlidingWindowNormalizer::UpdateSums()
+{
+    std::fill(mSums.begin(), mSums.end(), 0.0);
+    std::fill(mSquareSums.begin(), mSquareSums.end(), 0.0);
+
+    for (unsigned int i = 0; i < mFrameCount; ++i)
+    {
+        const Real* values = &mWindow[static_cast<std::size_t>((mFirst + i) % mWindowSize) * mDimensionCount];
+
+        for (unsigned int d = 0; d < mDimensionCount; ++d)
+        {
+            mSums[d] += values[d];
+            mSquareSums[d] += values[d] * values[d];
+        }
+    }
+
+    mRemovedCount = 0;
+}
@@ -0,0 +1,243 @@
+#include "SpeakerIndex.h"
+
+#include "LineIndex.h"
+#include "SpeechData.h"
+
+#include <filesystem>
+
+namespace
+{
+    const char* const INDEX_FILE_NAME = "speakers.idx";
+    const char* const INDEX_HEADER = "SpeakerIndex";
+    const unsigned int INDEX_VERSION = 3;
+
+    /*! \brief Placeholder for an empty speaker id in the index file.
+     */
+    const char* const EMPTY_SPEAKER_ID = "-";
+}
+
+SpeakerIndex::SpeakerIndex()
+{
+
+}
+
+SpeakerIndex::~SpeakerIndex()
+{
+
+}
+
+bool SpeakerIndex::Load(const std::string& folder)
+{
+    if (Read(folder + "/" + INDEX_FILE_NAME) && IsCurrent(folder))
+    {
+        return true;
+    }
+
+    return Build(folder);
+}
+
+bool SpeakerIndex::Build(const std::string& folder)
+{
+    std::cout << "Building speaker index: " << folder << std::endl;
+
+    mEntries.clear();
+
+    for (unsigned int fileNumber : FindSampleFiles(folder))
+    {
+        std::string path = GetSamplesPath(folder, fileNumber);
+
+        std::shared_ptr<const LineIndex> lineIndex = LineIndex::Get(path);
+
+        if (!lineIndex)
+        {
+            continue;
+        }
+
+        Entry entry;
+        entry.size = GetFileSize(path);
+        entry.modificationTime = GetFileModificationTime(path);
+        entry.lineCount = lineIndex->GetLineCount();
+
+        std::ifstream file(path);
+        std::string line;
+
+        if (std::getline(file, line) && line.size() >= 3)
+        {
+            entry.speakerId = line.substr(0, 3);
+        }
+
+        if (entry.speakerId.empty())
+        {
+            std::cout << "Scanning failed: insufficient data in " << path << "." << std::endl;
+        }
+
+        mEntries[fileNumber] = entry;
+    }
+
+    if (!Write(folder + "/" + INDEX_FILE_NAME))
+    {
+        std::cout << "Could not save speaker index: " << folder << std::endl;
+    }
+
+    return true;
+}
+
+const SpeakerIndex::Entry* SpeakerIndex::GetEntry(unsigned int fileNumber) const
+{
+    auto it = mEntries.find(fileNumber);
+
+    if (it == mEntries.end())
+    {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+std::shared_ptr<const SpeakerIndex> SpeakerIndex::Get(const std::string& folder)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const SpeakerIndex> > indices;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& index = indices[folder];
+
+    if (!index)
+    {
+        auto newIndex = std::make_shared<SpeakerIndex>();
+        newIndex->Load(folder);
+
+        index = newIndex;
+    }
+
+    return index;
+}
+
+bool SpeakerIndex::Read(const std::string& path)
+{
+    mEntries.clear();
+
+    std::ifstream file(path);
+
+    std::string header;
+    unsigned int version = 0;
+
+    if (!(file >> header >> version) || header != INDEX_HEADER || version != INDEX_VERSION)
+    {
+        return false;
+    }
+
+    unsigned int fileNumber;
+
+    while (file >> fileNumber)
+    {
+        Entry entry;
+
+        if (!(file >> entry.speakerId >> entry.size >> entry.modificationTime >> entry.lineCount))
+        {
+            mEntries.clear();
+            return false;
+        }
+
+        if (entry.speakerId == EMPTY_SPEAKER_ID)
+        {
+            entry.speakerId.clear();
+        }
+
+        mEntries[fileNumber] = entry;
+    }
+
+    return file.eof();
+}
+
+bool SpeakerIndex::Write(const std::string& path) const
+{
+    // Written to a temporary file first so that concurrent readers never see a partial index.
+    std::string tempPath = path + ".tmp";
+
+    {
+        std::ofstream file(tempPath);
+
+        if (!file.good())
+        {
+            return false;
+        }
+
+        file << INDEX_HEADER << " " << INDEX_VERSION << std::endl;
+
+        for (const auto& it : mEntries)
+        {
+            const Entry& entry = it.second;
+
+            file << it.first << " " << (entry.speakerId.empty() ? EMPTY_SPEAKER_ID : entry.speakerId)
+                << " " << entry.size << " " << entry.modificationTime << " " << entry.lineCount << '\n';
+        }
+
+        if (!file.good())
+        {
+            return false;
+        }
+    }
+
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+bool SpeakerIndex::IsCurrent(const std::string& folder) const
+{
+    std::vector<unsigned int> fileNumbers = FindSampleFiles(folder);
+
+    if (fileNumbers.size() != mEntries.size())
+    {
+        return false;
+    }
+
+    for (unsigned int fileNumber : fileNumbers)
+    {
+        const Entry* entry = GetEntry(fileNumber);
+        std::string path = GetSamplesPath(folder, fileNumber);
+
+        if (!entry || entry->size != GetFileSize(path) || entry->modificationTime != GetFileModificationTime(path))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<unsigned int> SpeakerIndex::FindSampleFiles(const std::string& folder)
+{
+    std::vector<unsigned int> fileNumbers;
+
+    std::error_code error;
+
+    for (auto it = std::filesystem::directory_iterator(folder, error); !error && it != std::filesystem::directory_iterator(); it.increment(error))
+    {
+        std::string name = it->path().filename().string();
+
+        const std::string prefix = "samples_";
+        const std::string suffix = ".txt";
+
+        if (name.size() <= prefix.size() + suffix.size()
+            || name.compare(0, prefix.size(), prefix) != 0
+            || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+        {
+            continue;
+        }
+
+        std::string number = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+
+        // Numbers with leading zeros would not match GetSamplesPath().
+        if (number.find_first_not_of("0123456789") != std::string::npos || number[0] == '0' || number.size() > 9)
+        {
+            continue;
+        }
+
+        fileNumbers.push_back(std::stoul(number));
+    }
+
+    std::sort(fileNumbers.begin(), fileNumbers.end());
+
+    return fileNumbers;
+}
@@ -1,9 +1,21 @@
 #include "SpeechData.h"
 
+#include "FeatureFile.h"
+#include "FeatureParser.h"
+#include "FeatureWarper.h"
+#include "LineIndex.h"
+#include "MeanVarianceNormalizer.h"
+#include "SlidingWindowNormalizer.h"
+#include "SpeakerIndex.h"
+#include "ThreadPool.h"
+
 SpeechData::SpeechData()
     : mNormalizationType(FeatureNormalizationType::CEPSTRAL_MEAN_VARIANCE),
+    mNormalizationWindow(300),
     mConsistent(true),
-    mDimensionCount(0)
+    mDimensionMismatch(false),
+    mDimensionCount(0),
+    mLogDeferred(false)
 {
 
 }
@@ -33,46 +45,37 @@ void SpeechData::Load(const std::string& path)
 
     unsigned int lineCounter = 0;
 
+    std::vector<Real> frame;
+
     while(std::getline(file, line))
     {
-        std::stringstream ssFeatures(line);
+        FeatureParser parser(line);
 
         std::string label;
         SpeakerKey key;
 
-        if (ssFeatures >> label)
+        if (parser.ReadLabel(label))
         {
             std::cout << "Loading samples: " << label
                 << " (" << 100 * lineCounter / totalLines << "%)" << std::endl;
 
-            std::string features;
-
             key = SpeakerKey(label);
 
             auto& userSamples = mSamples[SpeakerKey(label)];
 
-            while (std::getline(ssFeatures, features, ','))
-            {
-                userSamples.emplace_back();
-
-                std::stringstream ssFeature(features);
-                std::string feature;
+            userSamples.BeginUtterance();
 
-                while (std::getline(ssFeature, feature, ' '))
-                {
-                    if (feature.size() > 0 && feature[0] != ' ')
-                    {
-                        userSamples.back().Push(ConvertString<Real>(feature));
-                    }
-                }
+            while (parser.ReadFrame<Real>(frame))
+            {
+                AddFrame(userSamples, frame);
+            }
 
-                if (userSamples.back().GetSize() == 0)
-                {
-                    userSamples.pop_back();
-                }
+            if (parser.HasError())
+            {
+                std::cout << "Invalid feature value on line " << lineCounter + 1 << "." << std::endl;
             }
 
-            if (userSamples.size() == 0)
+            if (userSamples.GetFrameCount() == 0)
             {
                 mSamples.erase(key);
 
@@ -88,20 +91,14 @@ void SpeechData::Load(const std::string& path)
 
 void SpeechData::Load(const std::string& path, unsigned int sl, unsigned int gl, unsigned int multiplier, bool train, unsigned int maxFeatures, bool normalize, const std::string& alias)
 {
-    std::ifstream file(path);
-
-    std::string line;
-
-    unsigned int lineCounter = 1;
-    
     if (train)
     {
-        std::cout << "Loading train samples." << std::endl;
+        GetLog() << "Loading train samples." << std::endl;
     }
 
     else
     {
-        std::cout << "Loading samples, multiplier: " << multiplier
+        GetLog() << "Loading samples, multiplier: " << multiplier
                   << ", total lines: " << multiplier << "*" << gl << "=" << multiplier * gl << std::endl;
     }
 
@@ -109,122 +106,383 @@ void SpeechData::Load(const std::string& path, unsigned int sl, unsigned int gl,
     {
         gl = multiplier * gl;
     }
-    
-    unsigned int totalLines = sl+gl-1;
 
-    unsigned int lc = 0;
+    std::shared_ptr<const LineIndex> index = LineIndex::Get(path);
 
-    while(std::getline(file, line))
+    if (!index)
+    {
+        GetLog() << "Could not open file: " << path << std::endl;
+        return;
+    }
+
+    // Lines [sl, sl + gl - 1], where gl == 0 reads until the end
+    // of the file only if starting from the first line.
+    unsigned int totalLines = sl + gl - 1;
+    unsigned int firstLine = Max(sl, 1u);
+    unsigned int lastLine = index->GetLineCount();
+
+    if (totalLines != 0 && totalLines < lastLine)
+    {
+        lastLine = totalLines;
+    }
+
+    if (firstLine > lastLine)
+    {
+        return;
+    }
+
+    // Large ranges are split into disjoint blocks of lines that are read in parallel.
+    ThreadPool& threadPool = ThreadPool::GetDefault();
+
+    unsigned int lineCount = lastLine - firstLine + 1;
+    unsigned int blockCount = Min(threadPool.GetThreadCount(), (lineCount + PARALLEL_BLOCK_LINES - 1) / PARALLEL_BLOCK_LINES);
+
+    if (blockCount <= 1)
+    {
+        LoadLines(path, index->GetLineOffset(firstLine), firstLine, lastLine, sl, totalLines, multiplier, train, maxFeatures, normalize, alias);
+        return;
+    }
+
+    std::vector<SpeechData> partialData(blockCount);
+
+    threadPool.ParallelFor(blockCount, [&](unsigned int b) {
+        unsigned int begin = firstLine + static_cast<unsigned long long>(lineCount) * b / blockCount;
+        unsigned int end = firstLine + static_cast<unsigned long long>(lineCount) * (b + 1) / blockCount - 1;
+
+        partialData[b].SetLogDeferred(true);
+        partialData[b].SetNormalizationType(mNormalizationType);
+        partialData[b].SetNormalizationWindow(mNormalizationWindow);
+        partialData[b].LoadLines(path, index->GetLineOffset(begin), begin, end, sl, totalLines, multiplier, train, maxFeatures, normalize, alias);
+    });
+
+    // Merge in line order so that the result does not depend on scheduling.
+    for (auto& partial : partialData)
+    {
+        Merge(partial);
+    }
+}
+
+void SpeechData::LoadLines(const std::string& path, std::uint64_t offset, unsigned int begin, unsigned int end, unsigned int sl, unsigned int totalLines, unsigned int multiplier, bool train, unsigned int maxFeatures, bool normalize, const std::string& alias)
+{
+    std::ifstream file(path);
+    file.seekg(offset);
+
+    std::string line;
+
+    // Zero-based index of the line within the loaded range.
+    unsigned int lc = begin - Max(sl, 1u);
+
+    std::vector<Real> frame;
+
+    for (unsigned int lineCounter = begin; lineCounter <= end && std::getline(file, line); ++lineCounter, ++lc)
     {
-        if (lineCounter >= sl)
+        FeatureParser parser(line);
+
+        std::string label;
+        SpeakerKey key;
+
+        if (parser.ReadLabel(label))
         {
-            SpeechDataBuffer buffer(const_cast<char*>(line.c_str()), line.size());
-            std::istream ssFeatures(&buffer);
+            std::string oldLabel = label;
 
-            std::string label;
-            SpeakerKey key;
+            label = GetSpeakerLabel(label, lc, multiplier, train, alias);
 
-            if (ssFeatures >> label)
+            if (!train && multiplier > 1)
             {
-                std::string oldLabel = label;
+                GetLog() << "Loading samples from '" << oldLabel << "' to '" << label << "'" << " mul " << multiplier
+                    << " (" << 100 * (lineCounter - sl + 1) / (totalLines - sl + 1) << "%)" << std::endl;
+            }
 
-                if (alias.size() >= 3)
-                {
-                    label[0] = alias[0];
-                    label[1] = alias[1];
-                    label[2] = alias[2];
-                }
+            else
+            {
+                GetLog() << "Loading samples from '" << oldLabel << "' to '" << label << "'"
+                    << " (" << 100 * (lineCounter - sl + 1) / (totalLines - sl + 1) << "%)" << std::endl;
+            }
 
-                if (train || multiplier > 1)
-                {
-                    label.erase(3);
-                }
+            key = SpeakerKey(label);
 
-                if (!train && multiplier > 1)
-                {
-                    std::stringstream ss;
-                    ss << label << "_" << (lc / multiplier) + 1;
-                    label = ss.str();
+            auto& userSamples = mSamples[key];
 
-                    std::cout << "Loading samples from '" << oldLabel << "' to '" << label << "'" << " mul " << multiplier
-                        << " (" << 100 * (lineCounter - sl + 1) / (totalLines - sl + 1) << "%)" << std::endl;
-                }
+            userSamples.BeginUtterance();
+
+            unsigned int totalVectors = 0;
 
-                else
+            // Values are parsed as floats like std::stof().
+            while (parser.ReadFrame<float>(frame, maxFeatures))
+            {
+                if (AddFrame(userSamples, frame))
                 {
-                    std::cout << "Loading samples from '" << oldLabel << "' to '" << label << "'"
-                        << " (" << 100 * (lineCounter - sl + 1) / (totalLines - sl + 1) << "%)" << std::endl;
+                    ++totalVectors;
                 }
-                
-                std::string features;
+            }
 
-                key = SpeakerKey(label);
+            if (parser.HasError())
+            {
+                GetLog() << "Invalid feature value in '" << oldLabel << "' on line " << lineCounter << "." << std::endl;
+            }
+
+            if (userSamples.GetFrameCount() == 0)
+            {
+                mSamples.erase(key);
 
-                auto& userSamples = mSamples[key];
+                GetLog() << "Error: missing sample data." << std::endl;
+            }
 
-                unsigned int totalVectors = 0;
-                
-                // Feature vectors separated by commas.
-                while (std::getline(ssFeatures, features, ','))
+            else
+            {
+                // Per-utterance normalization.
+                if (normalize)
                 {
-                    userSamples.emplace_back();
-
-                    SpeechDataBuffer buffer2(const_cast<char*>(features.c_str()), features.size());
-                    std::istream ssFeature(&buffer2);
-                    std::string feature;
-
-                    unsigned int featureCount = 0;
-
-                    // Features separated by spaces.
-                    while (std::getline(ssFeature, feature, ' '))
-                    {
-                        if (feature.size() > 0 && feature[0] != ' ')
-                        {
-                            if (featureCount++ == maxFeatures) break;
-
-                            userSamples.back().Push(std::stof(feature));
-                        }
-                    }
-
-                    if (userSamples.back().GetSize() > 0)
-                    {
-                        ++totalVectors;
-                    }
-
-                    else
-                    {
-                        userSamples.pop_back();
-                    }
+                    GetLog() << "Normalizing utterance of size: " << totalVectors << "." << std::endl;
+                    Normalize(userSamples, userSamples.GetFrameCount() - totalVectors, userSamples.GetFrameCount());
                 }
+            }
+        }
+    }
+}
 
-                if (userSamples.size() == 0)
-                {
-                    mSamples.erase(key);
+bool SpeechData::LoadBinary(const std::string& path, unsigned int sl, unsigned int gl, unsigned int multiplier, bool train, unsigned int maxFeatures, bool normalize, const std::string& alias)
+{
+    FeatureFile file;
 
-                    std::cout << "Error: missing sample data." << std::endl;
-                }
+    if (!file.Open(path))
+    {
+        return false;
+    }
 
-                else
-                {
-                    // Per-utterance normalization.
-                    if (normalize)
-                    {
-                        std::cout << "Normalizing utterance of size: " << totalVectors << "." << std::endl;
-                        Normalize(userSamples.end() - totalVectors, userSamples.end());
-                    }
-                }
+    if (train)
+    {
+        GetLog() << "Loading train samples (binary)." << std::endl;
+    }
+
+    else
+    {
+        GetLog() << "Loading samples (binary), multiplier: " << multiplier
+                  << ", total lines: " << multiplier << "*" << gl << "=" << multiplier * gl << std::endl;
+    }
+
+    if (!train && multiplier > 1)
+    {
+        gl = multiplier * gl;
+    }
+
+    // Same line range as the text version: lines [sl, sl + gl - 1], where
+    // gl == 0 reads until the end of the file only if starting from the first line.
+    unsigned int totalLines = sl + gl - 1;
+    unsigned int firstLine = Max(sl, 1u);
+    unsigned int lastLine = file.GetUtteranceCount();
+
+    if (totalLines != 0 && totalLines < lastLine)
+    {
+        lastLine = totalLines;
+    }
+
+    unsigned int dimensionCount = Min(file.GetDimensionCount(), maxFeatures);
+
+    unsigned int lc = 0;
+
+    for (unsigned int lineCounter = firstLine; lineCounter <= lastLine; ++lineCounter, ++lc)
+    {
+        std::string label = file.GetLabel(lineCounter - 1);
+
+        if (label.empty())
+        {
+            continue;
+        }
+
+        std::string oldLabel = label;
+
+        label = GetSpeakerLabel(label, lc, multiplier, train, alias);
+
+        GetLog() << "Loading samples from '" << oldLabel << "' to '" << label << "'"
+            << " (" << 100 * (lineCounter - sl + 1) / (totalLines - sl + 1) << "%)" << std::endl;
+
+        SpeakerKey key(label);
+
+        auto& userSamples = mSamples[key];
+
+        unsigned int totalVectors = (dimensionCount > 0) ? file.GetFrameCount(lineCounter - 1) : 0;
+
+        const float* frames = file.GetFrames(lineCounter - 1);
+
+        if (userSamples.GetFrameCount() == 0)
+        {
+            userSamples.SetDimensionCount(dimensionCount);
+        }
+
+        if (totalVectors > 0 && userSamples.GetDimensionCount() != dimensionCount)
+        {
+            GetLog() << "Feature count mismatch: " << dimensionCount << " features in '" << oldLabel
+                << "', expected " << userSamples.GetDimensionCount() << "." << std::endl;
+
+            mDimensionMismatch = true;
+            totalVectors = 0;
+        }
+
+        userSamples.BeginUtterance();
+        userSamples.Reserve(userSamples.GetFrameCount() + totalVectors);
+
+        for (unsigned int f = 0; f < totalVectors; ++f)
+        {
+            const float* frame = frames + f * file.GetDimensionCount();
+
+            Real* values = userSamples.AddFrame();
+
+            for (unsigned int d = 0; d < dimensionCount; ++d)
+            {
+                values[d] = frame[d];
             }
+        }
+
+        if (userSamples.GetFrameCount() == 0)
+        {
+            mSamples.erase(key);
 
-            ++lc;
+            GetLog() << "Error: missing sample data." << std::endl;
         }
 
-        if (lineCounter == totalLines)
+        // Per-utterance normalization.
+        else if (normalize && totalVectors > 0)
         {
-            break;
+            GetLog() << "Normalizing utterance of size: " << totalVectors << "." << std::endl;
+            Normalize(userSamples, userSamples.GetFrameCount() - totalVectors, userSamples.GetFrameCount());
         }
+    }
 
-        ++lineCounter;
+    return true;
+}
+
+std::string SpeechData::GetSpeakerLabel(const std::string& label, unsigned int utterance, unsigned int multiplier, bool train, const std::string& alias) const
+{
+    std::string result = label;
+
+    if (alias.size() >= 3)
+    {
+        result[0] = alias[0];
+        result[1] = alias[1];
+        result[2] = alias[2];
+    }
+
+    if (train || multiplier > 1)
+    {
+        result.erase(3);
+    }
+
+    if (!train && multiplier > 1)
+    {
+        std::stringstream ss;
+        ss << result << "_" << (utterance / multiplier) + 1;
+        result = ss.str();
+    }
+
+    return result;
+}
+
+bool SpeechData::AddFrame(FrameMatrix& frames, const std::vector<Real>& values)
+{
+    if (values.empty())
+    {
+        return false;
+    }
+
+    if (frames.GetFrameCount() == 0 && frames.GetDimensionCount() != values.size())
+    {
+        frames.SetDimensionCount(values.size());
+    }
+
+    if (frames.GetDimensionCount() != values.size())
+    {
+        GetLog() << "Feature count mismatch: " << values.size() << " features, expected "
+            << frames.GetDimensionCount() << "." << std::endl;
+
+        mDimensionMismatch = true;
+
+        return false;
+    }
+
+    frames.AddFrame(values.data());
+
+    return true;
+}
+
+void SpeechData::AddUtterance(const std::string& label, const FrameView& frames)
+{
+    if (frames.IsEmpty())
+    {
+        return;
+    }
+
+    auto& userSamples = mSamples[SpeakerKey(label)];
+
+    if (userSamples.GetFrameCount() == 0)
+    {
+        userSamples.SetDimensionCount(frames.GetDimensionCount());
+    }
+
+    if (userSamples.GetDimensionCount() != frames.GetDimensionCount())
+    {
+        std::cout << "Feature count mismatch: " << frames.GetDimensionCount() << " features in '" << label
+            << "', expected " << userSamples.GetDimensionCount() << "." << std::endl;
+
+        mDimensionMismatch = true;
+        return;
+    }
+
+    userSamples.Append(frames);
+}
+
+void SpeechData::Merge(SpeechData& other)
+{
+    for (auto& entry : other.mSamples)
+    {
+        auto it = mSamples.find(entry.first);
+
+        if (it == mSamples.end())
+        {
+            mSamples.emplace(entry.first, std::move(entry.second));
+        }
+
+        else if (it->second.GetDimensionCount() != entry.second.GetDimensionCount())
+        {
+            GetLog() << "Feature count mismatch: " << entry.second.GetDimensionCount() << " features in '"
+                << entry.first << "', expected " << it->second.GetDimensionCount() << "." << std::endl;
+
+            mDimensionMismatch = true;
+        }
+
+        else
+        {
+            it->second.Append(entry.second);
+        }
     }
+
+    mDimensionMismatch = mDimensionMismatch || other.mDimensionMismatch;
+
+    // Messages of data loaded on another thread follow in merge order.
+    GetLog() << other.mLog.str() << std::flush;
+    other.mLog.str("");
+
+    other.Clear();
+}
+
+void SpeechData::SetLogDeferred(bool deferred)
+{
+    mLogDeferred = deferred;
+}
+
+bool SpeechData::IsLogDeferred() const
+{
+    return mLogDeferred;
+}
+
+std::ostream& SpeechData::GetLog()
+{
+    if (mLogDeferred)
+    {
+        return mLog;
+    }
+
+    return std::cout;
 }
 
 void SpeechData::Validate()
@@ -234,32 +492,35 @@ void SpeechData::Validate()
 
     std::cout << "Validating speech data..." << std::endl;
 
+    if (mDimensionMismatch)
+    {
+        std::cout << "Speech data not valid: feature count mismatch." << std::endl;
+
+        return;
+    }
+
     unsigned int featureCount = 0;
 
-    if (mSamples.size() > 0
-        && (*mSamples.begin()).second.size() > 0) // Samples
+    if (mSamples.size() > 0) // Samples
     {
-        // First feature vector of first sample.
-        featureCount = (*mSamples.begin()).second.front().GetSize();
+        // Features of the first sample.
+        featureCount = (*mSamples.begin()).second.GetDimensionCount();
     }
 
     for (const auto& entry : mSamples)
     {
-        for (const auto& sample : entry.second)
+        if (entry.second.GetDimensionCount() != featureCount)
         {
-            if (sample.GetSize() != featureCount)
-            {
-                std::cout << featureCount << std::endl;
-                std::cout << sample.GetSize() << std::endl;
-                std::cout << "Speech data not valid: feature count mismatch." << std::endl;
-
-                mTotalSampleCount = 0;
+            std::cout << featureCount << std::endl;
+            std::cout << entry.second.GetDimensionCount() << std::endl;
+            std::cout << "Speech data not valid: feature count mismatch." << std::endl;
 
-                return;
-            }
+            mTotalSampleCount = 0;
 
-            ++mTotalSampleCount;
+            return;
         }
+
+        mTotalSampleCount += entry.second.GetFrameCount();
     }
 
     std::cout << "Speech data valid." << std::endl;
@@ -272,6 +533,7 @@ void SpeechData::Clear()
 {
     mSamples.clear();
     mConsistent = true;
+    mDimensionMismatch = false;
     mTotalSampleCount = 0;
     mDimensionCount = 0;
 }
@@ -304,44 +566,25 @@ FeatureNormalizationType SpeechData::GetNormalizationType() const
     return mNormalizationType;
 }
 
-void SpeechData::CMVN(
-    std::vector < DynamicVector<Real> >::iterator beginIt,
-    std::vector < DynamicVector<Real> >::iterator endIt)
+void SpeechData::SetNormalizationWindow(unsigned int windowSize)
 {
-    DynamicVector<Real> means;
-    DynamicVector<Real> deviations;
-
-    means.Resize(beginIt->GetSize());
-    deviations.Resize(beginIt->GetSize());
-
-    // Normalize dimensions separately.
-    for (unsigned int d = 0; d < beginIt->GetSize(); d++)
-    {
-        std::vector<Real> values;
+    mNormalizationWindow = windowSize;
+}
 
-        for (auto it = beginIt; it != endIt; it++)
-        {
-            values.push_back((*it)[d]);
-        }
+unsigned int SpeechData::GetNormalizationWindow() const
+{
+    return mNormalizationWindow;
+}
 
-        // Get mean & deviation over all samples.
-        Real mean = Mean(values);
-        Real deviation = Deviation(values, mean);
+void SpeechData::CMVN(FrameMatrix& frames, unsigned int begin, unsigned int end)
+{
+    MeanVarianceNormalizer normalizer(frames.GetDimensionCount());
 
-        means[d] = mean;
-        deviations[d] = deviation;
-    }
-    
-    for (auto it = beginIt; it != endIt; it++)
-    {
-        it->Subtract(means);
-        it->Divide(deviations);
-    }
+    normalizer.Add(frames.GetFrames(begin, end));
+    normalizer.Normalize(frames, begin, end);
 }
 
-void SpeechData::Normalize(
-    std::vector < DynamicVector<Real> >::iterator beginIt,
-    std::vector < DynamicVector<Real> >::iterator endIt)
+void SpeechData::Normalize(FrameMatrix& frames, unsigned int begin, unsigned int end)
 {
     switch (mNormalizationType)
     {
@@ -349,7 +592,24 @@ void SpeechData::Normalize(
         break;
 
     case FeatureNormalizationType::CEPSTRAL_MEAN_VARIANCE:
-        CMVN(beginIt, endIt);
+        CMVN(frames, begin, end);
+
+        break;
+
+    case FeatureNormalizationType::SLIDING_CEPSTRAL_MEAN_VARIANCE:
+    {
+        SlidingWindowNormalizer normalizer(frames.GetDimensionCount(), mNormalizationWindow);
+
+        for (unsigned int f = begin; f < end; ++f)
+        {
+            normalizer.Normalize(frames[f]);
+        }
+
+        break;
+    }
+
+    case FeatureNormalizationType::FEATURE_WARPING:
+        FeatureWarper(mNormalizationWindow).Warp(frames, begin, end);
 
         break;
 
@@ -360,11 +620,72 @@ void SpeechData::Normalize(
 
 void SpeechData::Normalize()
 {
+    std::vector<FrameMatrix*> entries;
+
+    for (auto& sample : mSamples)
+    {
+        entries.push_back(&sample.second);
+    }
+
     // Normalize entry by entry.
+    ThreadPool::GetDefault().ParallelFor(entries.size(), [this, &entries](unsigned int i) {
+        FrameMatrix& frames = *entries[i];
+
+        if (   mNormalizationType == FeatureNormalizationType::SLIDING_CEPSTRAL_MEAN_VARIANCE
+            || mNormalizationType == FeatureNormalizationType::FEATURE_WARPING)
+        {
+            for (unsigned int u = 0; u < frames.GetUtteranceCount(); ++u)
+            {
+                Normalize(frames, frames.GetUtteranceBegin(u), frames.GetUtteranceEnd(u));
+            }
+        }
+
+        else
+        {
+            Normalize(frames, 0, frames.GetFrameCount());
+        }
+    });
+}
+
+unsigned int SpeechData::RemoveSilence(const VoiceActivityDetector& detector, unsigned int energyDimension)
+{
+    std::vector<FrameMatrix*> entries;
+
     for (auto& sample : mSamples)
     {
-        Normalize(sample.second.begin(), sample.second.end());
+        entries.push_back(&sample.second);
     }
+
+    std::vector<unsigned int> removed(entries.size(), 0);
+
+    ThreadPool::GetDefault().ParallelFor(entries.size(), [&](unsigned int i) {
+        VoiceActivityDetector speakerDetector = detector;
+        removed[i] = speakerDetector.Filter(*entries[i], energyDimension);
+    });
+
+    // Speakers without speech are removed.
+    for (auto it = mSamples.begin(); it != mSamples.end();)
+    {
+        if (it->second.GetFrameCount() == 0)
+        {
+            std::cout << "No speech frames: " << it->first << std::endl;
+            it = mSamples.erase(it);
+        }
+
+        else
+        {
+            ++it;
+        }
+    }
+
+    unsigned int total = 0;
+
+    for (unsigned int count : removed)
+    {
+        total += count;
+    }
+
+    return total;
 }
 
 unsigned int SpeechData::GetSpeakerCount() const
@@ -377,39 +698,84 @@ unsigned int SpeechData::GetTotalSampleCount() const
     return mTotalSampleCount;
 }
 
-const std::map<SpeakerKey, std::vector<DynamicVector<Real> > >& SpeechData::GetSamples() const
+std::size_t SpeechData::GetMemoryUsage() const
+{
+    std::size_t usage = sizeof(SpeechData);
+
+    for (const auto& entry : mSamples)
+    {
+        usage += sizeof(entry) + entry.first.GetId().capacity() + entry.second.GetMemoryUsage();
+    }
+
+    return usage;
+}
+
+const std::map<SpeakerKey, FrameMatrix>& SpeechData::GetSamples() const
 {
     return mSamples;
 }
 
-void LoadTextSamples(const std::string& folder, const std::shared_ptr<SpeechData>& data, unsigned int sf, unsigned int gf, unsigned int sl, unsigned int gl, unsigned int multiplier, bool train)
+bool ParseFeatureFolder(const std::string& name, FeatureFolder& folder)
 {
-    if (folder.size() == 0)
+    if (name.size() == 0)
     {
         std::cout << "Could not load samples: Missing folder name." << std::endl;
-        return;
+        return false;
     }
-    
-    bool cmvn = false;
-    unsigned int maxFeatures = 39;
 
-    std::stringstream ss(folder);
+    folder = FeatureFolder();
 
-    std::string finalFolder;
+    std::stringstream ss(name);
 
-    if (!std::getline(ss, finalFolder, '_'))
+    if (!std::getline(ss, folder.path, '_'))
     {
         std::cout << "Invalid folder name." << std::endl;
-        return;
+        return false;
     }
 
     std::string str;
 
     while (std::getline(ss, str, '_'))
     {
-        if (str == "cmvn")
+        if (str.compare(0, 4, "cmvn") == 0)
         {
-            cmvn = true;
+            folder.cmvn = true;
+
+            if (str.size() > 4)
+            {
+                try
+                {
+                    folder.cmvnWindow = std::stoi(str.substr(4));
+                }
+
+                catch (...)
+                {
+                    std::cout << "Invalid CMVN window format." << std::endl;
+                }
+            }
+        }
+
+        else if (str == "vad")
+        {
+            folder.vad = true;
+        }
+
+        else if (str.compare(0, 4, "warp") == 0)
+        {
+            folder.warp = true;
+
+            if (str.size() > 4)
+            {
+                try
+                {
+                    folder.warpWindow = std::stoi(str.substr(4));
+                }
+
+                catch (...)
+                {
+                    std::cout << "Invalid warping window format." << std::endl;
+                }
+            }
         }
 
         else if (str.size() > 0 && str[0] == 'f')
@@ -418,7 +784,7 @@ void LoadTextSamples(const std::string& folder, const std::shared_ptr<SpeechData
 
             try
             {
-                maxFeatures = std::stoi(str);
+                folder.maxFeatures = std::stoi(str);
             }
 
             catch (...)
@@ -428,20 +794,86 @@ void LoadTextSamples(const std::string& folder, const std::shared_ptr<SpeechData
         }
     }
 
+    return true;
+}
+
+std::string GetSamplesPath(const std::string& folder, unsigned int index)
+{
+    return folder + "/samples_" + toString(index) + ".txt";
+}
+
+void LoadTextSamples(const std::string& folder, const std::shared_ptr<SpeechData>& data, unsigned int sf, unsigned int gf, unsigned int sl, unsigned int gl, unsigned int multiplier, bool train)
+{
+    FeatureFolder options;
+
+    if (!ParseFeatureFolder(folder, options))
+    {
+        return;
+    }
+
+    // Load files in parallel to separate data sets. Their messages are printed when merged.
+    std::vector<SpeechData> partialData(gf);
+
+    ThreadPool::GetDefault().ParallelFor(gf, [&](unsigned int i) {
+        std::string file = GetSamplesPath(options.path, sf + i);
+        std::string binaryFile = GetBinarySamplesPath(file);
+
+        partialData[i].SetLogDeferred(true);
+        partialData[i].GetLog() << file << std::endl;
+
+        std::string alias = GetSpeakerString(sf + i, folder);
+
+        partialData[i].SetNormalizationType(data->GetNormalizationType());
+        partialData[i].SetNormalizationWindow(data->GetNormalizationWindow());
+
+        // Prefer the binary version of the file unless the text file has been modified after conversion.
+        if (FileExists(binaryFile) && GetFileModificationTime(binaryFile) >= GetFileModificationTime(file)
+            && partialData[i].LoadBinary(binaryFile, sl, gl, multiplier, train, options.maxFeatures, false, alias))
+        {
+            return;
+        }
+
+        partialData[i].Load(file, sl, gl, multiplier, train, options.maxFeatures, false, alias);
+    });
+
+    // Merge in file order so that the result does not depend on scheduling.
     data->Clear();
-    for (unsigned int i = 0; i < gf; i++)
+    for (auto& partial : partialData)
     {
-        std::string file = finalFolder + "/samples_" + toString(sf+i) + ".txt";
-        std::cout << file << std::endl;
-        data->Load(file, sl, gl, multiplier, train, maxFeatures, false, GetSpeakerString(sf + i, folder));
+        data->Merge(partial);
     }
     data->Validate();
 
     std::cout << "Dimensions: " << data->GetDimensionCount() << std::endl;
 
-    if (cmvn)
+    if (options.vad)
+    {
+        unsigned int removed = data->RemoveSilence(VoiceActivityDetector());
+        data->Validate();
+
+        std::cout << "Voice activity detection removed " << removed << " frames." << std::endl;
+    }
+
+    if (options.warp)
+    {
+        std::cout << "Normalizing (feature warping, window " << options.warpWindow << ")..." << std::endl;
+        data->SetNormalizationType(FeatureNormalizationType::FEATURE_WARPING);
+        data->SetNormalizationWindow(options.warpWindow);
+        data->Normalize();
+    }
+
+    if (options.cmvn && options.cmvnWindow > 0)
+    {
+        std::cout << "Normalizing (sliding CMVN, window " << options.cmvnWindow << ")..." << std::endl;
+        data->SetNormalizationType(FeatureNormalizationType::SLIDING_CEPSTRAL_MEAN_VARIANCE);
+        data->SetNormalizationWindow(options.cmvnWindow);
+        data->Normalize();
+    }
+
+    else if (options.cmvn)
     {
         std::cout << "Normalizing (CMVN)..." << std::endl;
+        data->SetNormalizationType(FeatureNormalizationType::CEPSTRAL_MEAN_VARIANCE);
         data->Normalize();
     }
 }
@@ -449,60 +881,22 @@ void LoadTextSamples(const std::string& folder, const std::shared_ptr<SpeechData
 std::string GetSpeakerString(unsigned int index, const std::string& folder)
 {
 #ifdef INDEXFIX
-    if (folder.size() == 0)
-    {
-        std::cout << "Could not load samples: Missing folder name." << std::endl;
-        return "";
-    }
-    
-    std::stringstream ss(folder);
-
-    std::string finalFolder;
+    FeatureFolder options;
 
-    if (!std::getline(ss, finalFolder, '_'))
+    if (!ParseFeatureFolder(folder, options))
     {
-        std::cout << "Invalid folder name." << std::endl;
         return "";
     }
 
-    static std::vector<std::string> speakerFiles;
-    static bool speakerFilesScanned = false;
+    const SpeakerIndex::Entry* entry = SpeakerIndex::Get(options.path)->GetEntry(index);
 
-    if (!speakerFilesScanned)
+    if (!entry || entry->speakerId.empty())
     {
-        for (unsigned int i = 1; i <= 109; ++i)
-        {
-            std::string fname = finalFolder + "/samples_" + toString(i) + ".txt";
-                
-            std::ifstream infile(fname);
-                
-            if (infile.good())
-            {
-                std::string line;
-                getline(infile, line);
-
-                if (line.size() >= 3)
-                {
-                    std::string id;
-                    id += line[0];
-                    id += line[1];
-                    id += line[2];
-
-                    speakerFiles.push_back(id);
-
-                    std::cout << "Scanned: " << i << ":" << id << std::endl;
-                }
-                else
-                {
-                    std::cout << "Scanning failed: insufficient data." << std::endl;
-                }
-            }
-        }
-
-        speakerFilesScanned = true;
+        std::cout << "No speaker id for samples file: " << index << std::endl;
+        return "";
     }
 
-    return speakerFiles[index - 1];
+    return entry->speakerId;
 
 #else
     return toString(index);
@@ -27,6 +27,8 @@ void TestEngine::Run(const std::string& file)
     unsigned int ubmGf = 0;
     unsigned int ubmSl = 0;
     unsigned int ubmGl = 0;
+
+    unsigned int threadCount = 1;
     
     std::map<std::string, TestHeader> testIds;
     
@@ -71,6 +73,30 @@ void TestEngine::Run(const std::string& file)
             continue;
         }
 
+        if (item == "%cache")
+        {
+            unsigned int megabytes = 0;
+
+            if (!(ssLine >> megabytes)) {
+                std::cout << "Missing cache size." << std::endl;
+                return;
+            }
+
+            mDatasetCache.SetMemoryBudget(static_cast<std::size_t>(megabytes) * 1024u * 1024u);
+
+            continue;
+        }
+
+        if (item == "%threads")
+        {
+            if (!(ssLine >> threadCount)) {
+                std::cout << "Missing thread count." << std::endl;
+                return;
+            }
+
+            continue;
+        }
+
         if (item.size() > 1 && item[0] == '%')
         {
             std::string ttype;
@@ -235,11 +261,112 @@ void TestEngine::Run(const std::string& file)
                     test.weighting = true;
                 } else if (feature == "-ubm") {
                     test.ubm = true;
+                } else if (feature == "-full") {
+                    test.fullCovariance = true;
                 } else if (feature == "-o") {
                     if (!(ssLine >> test.order)) {
                         std::cout << "Error: invalid order." << std::endl;
                         return;
                     }
+                } else if (feature == "-topc") {
+                    if (!(ssLine >> test.topComponents)) {
+                        std::cout << "Error: invalid top component count." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-ai") {
+                    if (!(ssLine >> test.adaptationIterations)) {
+                        std::cout << "Error: invalid adaptation iteration count." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-rf") {
+                    if (!(ssLine >> test.relevanceFactor) || test.relevanceFactor < 0.0f) {
+                        std::cout << "Error: invalid relevance factor." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-rfs") {
+                    std::string factors;
+
+                    ssLine >> factors;
+
+                    std::stringstream ssFactors(factors);
+
+                    std::string factor;
+
+                    while (std::getline(ssFactors, factor, ','))
+                    {
+                        std::stringstream ssFactor(factor);
+
+                        Real relevanceFactor = 0.0f;
+
+                        if (!(ssFactor >> relevanceFactor) || relevanceFactor < 0.0f) {
+                            std::cout << "Error: invalid relevance factor '" << factor << "'." << std::endl;
+                            return;
+                        }
+
+                        test.relevanceFactors.push_back(relevanceFactor);
+                    }
+
+                    if (test.relevanceFactors.empty()) {
+                        std::cout << "Error: missing relevance factors." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-atopc") {
+                    if (!(ssLine >> test.adaptationTopComponents)) {
+                        std::cout << "Error: invalid adaptation top component count." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-exp") {
+                    std::string accuracy;
+
+                    ssLine >> accuracy;
+
+                    if (accuracy == "exact") {
+                        test.expAccuracy = ExpAccuracy::EXACT;
+                    } else if (accuracy == "high") {
+                        test.expAccuracy = ExpAccuracy::HIGH;
+                    } else if (accuracy == "medium") {
+                        test.expAccuracy = ExpAccuracy::MEDIUM;
+                    } else if (accuracy == "low") {
+                        test.expAccuracy = ExpAccuracy::LOW;
+                    } else {
+                        std::cout << "Error: invalid exp accuracy '" << accuracy << "'." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-exptol") {
+                    if (!(ssLine >> test.expTolerance) || test.expTolerance < 0.0f) {
+                        std::cout << "Error: invalid exp tolerance." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-pthr") {
+                    if (!(ssLine >> test.posteriorThreshold) || test.posteriorThreshold < 0.0f || test.posteriorThreshold > 1.0f) {
+                        std::cout << "Error: invalid posterior threshold." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-batch") {
+                    if (!(ssLine >> test.batchSize)) {
+                        std::cout << "Error: invalid batch size." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-batches") {
+                    if (!(ssLine >> test.batchCount)) {
+                        std::cout << "Error: invalid batch count." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-step") {
+                    if (!(ssLine >> test.stepExponent) || test.stepExponent <= 0.5f || test.stepExponent > 1.0f) {
+                        std::cout << "Error: invalid step exponent." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-reduce") {
+                    if (!(ssLine >> test.reducedOrder)) {
+                        std::cout << "Error: invalid reduced order." << std::endl;
+                        return;
+                    }
+                } else if (feature == "-rloss") {
+                    if (!(ssLine >> test.reductionLossBudget) || test.reductionLossBudget < 0.0f) {
+                        std::cout << "Error: invalid reduction loss budget." << std::endl;
+                        return;
+                    }
                 } else if (feature == "-mul") {
                     if (!(ssLine >> test.multiplier) || test.multiplier == 0) {
                         std::cout << "Error: invalid multiplier." << std::endl;
@@ -267,6 +394,29 @@ void TestEngine::Run(const std::string& file)
             test.type = testType;
             test.index = indexCounter;
 
+            // A sweep runs the test for each relevance factor with the same speaker models.
+            if (!test.relevanceFactors.empty())
+            {
+                std::string label = test.label;
+
+                for (Real factor : test.relevanceFactors)
+                {
+                    test.relevanceFactor = factor;
+                    test.index = indexCounter;
+
+                    if (!label.empty())
+                    {
+                        test.label = label + " rf=" + toString(factor);
+                    }
+
+                    tests.push_back(test);
+
+                    ++indexCounter;
+                }
+
+                continue;
+            }
+
             tests.push_back(test);
 
             ++indexCounter;
@@ -320,6 +470,9 @@ void TestEngine::Run(const std::string& file)
     
     std::shared_ptr<VQRecognizer> vq = std::make_shared<VQRecognizer>();
     std::shared_ptr<GMMRecognizer> gmm = std::make_shared<GMMRecognizer>();
+
+    vq->SetThreadCount(threadCount);
+    gmm->SetThreadCount(threadCount);
     
     auto previousIt = tests.end();
 
@@ -402,10 +555,8 @@ void TestEngine::Run(const std::string& file)
             it->trainGl  != previousIt->trainGl)
         {
             // Load speaker data.
-            trainData = std::make_shared<SpeechData>();
-            LoadTextSamples(
+            trainData = mDatasetCache.Load(
                 it->features,
-                trainData,
                 it->trainSf,
                 it->trainGf,
                 it->trainSl,
@@ -419,8 +570,7 @@ void TestEngine::Run(const std::string& file)
             it->features != previousIt->features)
         {
             // Load ubm data from a different set of speakers.
-            ubmData = std::make_shared<SpeechData>();
-            LoadTextSamples(it->features, ubmData, ubmSf, ubmGf, ubmSl, ubmGl, 1, true);
+            ubmData = mDatasetCache.Load(it->features, ubmSf, ubmGf, ubmSl, ubmGl, 1, true);
         }
 
         if (it->recognizerType == RecognizerType::VQ)
@@ -431,6 +581,17 @@ void TestEngine::Run(const std::string& file)
 
         else if (it->recognizerType == RecognizerType::GMM)
         {
+            gmm->SetCovarianceType(it->fullCovariance ? CovarianceType::FULL : CovarianceType::DIAGONAL);
+            gmm->SetTopComponentCount(it->topComponents);
+            gmm->SetAdaptationTopComponentCount(it->adaptationTopComponents);
+            gmm->SetExpAccuracy(it->expAccuracy);
+            gmm->SetExpTolerance(it->expTolerance);
+            gmm->SetPosteriorThreshold(it->posteriorThreshold);
+            gmm->SetBatchSize(it->batchSize);
+            gmm->SetBatchCount(it->batchCount);
+            gmm->SetStepExponent(it->stepExponent);
+            gmm->SetReducedOrder(it->reducedOrder);
+            gmm->SetReductionLossBudget(it->reductionLossBudget);
             recognizer = gmm;
         }
 
@@ -441,6 +602,9 @@ void TestEngine::Run(const std::string& file)
         }
 
         recognizer->SetOrder(it->order);
+        recognizer->SetAdaptationIterations(it->adaptationIterations);
+        recognizer->SetRelevanceFactors(it->relevanceFactors);
+        recognizer->SetRelevanceFactor(it->relevanceFactor);
         recognizer->SetBackgroundModelEnabled(it->ubm);
         recognizer->SetScoreNormalizationType(it->scoreNormalizationType);
         
@@ -521,10 +685,8 @@ void TestEngine::RecognizePop(
 
     std::ofstream results(resultsFileName, std::ios_base::app);
 
-    auto testData = std::make_shared<SpeechData>();
-
     // Test utterances
-    LoadTextSamples(test.features, testData, test.testSf, test.cycles * test.testGf, test.testSl, test.testGl, test.multiplier, false);
+    auto testData = mDatasetCache.Load(test.features, test.testSf, test.cycles * test.testGf, test.testSl, test.testGl, test.multiplier, false);
 
     for (unsigned int i = 1; i <= test.cycles ; i++)
     {
@@ -599,10 +761,8 @@ void TestEngine::Recognize(
 
     std::ofstream results(resultsFileName, std::ios_base::app);
 
-    auto testData = std::make_shared<SpeechData>();
-
     // Test utterances
-    LoadTextSamples(test.features, testData, test.testSf, test.testGf, test.testSl, test.testGl, test.multiplier, false);
+    auto testData = mDatasetCache.Load(test.features, test.testSf, test.testGf, test.testSl, test.testGl, test.multiplier, false);
     
     unsigned int correct = 0;
     unsigned int incorrect = 0;
@@ -637,7 +797,7 @@ void TestEngine::Recognize(
         std::cout << i + 1 << "/" << test.cycles << std::endl;
         
         // Test utterances
-        LoadTextSamples(test.features, testData, sf, test.testGf, test.testSl, test.testGl, test.multiplier, false);
+        testData = mDatasetCache.Load(test.features, sf, test.testGf, test.testSl, test.testGl, test.multiplier, false);
 
         Timer timer;
         for (const auto& samples : testData->GetSamples())
@@ -697,8 +857,7 @@ void TestEngine::Verify(
     }
     recognizer->SelectImpostorModels(impostors);
     
-    auto testData = std::make_shared<SpeechData>();
-    auto testData2 = std::make_shared<SpeechData>();
+    std::shared_ptr<SpeechData> testData;
     
     unsigned int sf = test.testSf;
 
@@ -734,7 +893,7 @@ void TestEngine::Verify(
         std::vector<Real> correctScores;
         std::vector<Real> incorrectScores;
         
-        LoadTextSamples(test.features, testData, sf, test.testGf, test.testSl, test.testGl, test.multiplier, false);
+        testData = mDatasetCache.Load(test.features, sf, test.testGf, test.testSl, test.testGl, test.multiplier, false);
 
         Timer timer;
         for (const auto& samples : testData->GetSamples())
@@ -0,0 +1,163 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+    : mStopping(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = Max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // The calling thread is one of the threads.
+    for (unsigned int t = 1; t < threadCount; ++t)
+    {
+        mWorkers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+
+    mJobAvailable.notify_all();
+
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::GetThreadCount() const
+{
+    return mWorkers.size() + 1;
+}
+
+void ThreadPool::ParallelFor(unsigned int count, const std::function<void(unsigned int)>& task)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (mWorkers.empty() || count == 1)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            task(i);
+        }
+
+        return;
+    }
+
+    Job job;
+    job.task = &task;
+    job.count = count;
+    job.next = 0;
+    job.activeWorkers = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.push_back(&job);
+    }
+
+    mJobAvailable.notify_all();
+
+    // Callers waiting for their own jobs can steal the tasks of this one.
+    mJobFinished.notify_all();
+
+    RunTasks(job);
+
+    // All tasks are claimed, steal tasks of other jobs while waiting for the workers still running them.
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (job.activeWorkers != 0)
+    {
+        Job* other = FindJob();
+
+        if (other == nullptr)
+        {
+            mJobFinished.wait(lock);
+            continue;
+        }
+
+        ++other->activeWorkers;
+
+        lock.unlock();
+
+        RunTasks(*other);
+
+        lock.lock();
+
+        --other->activeWorkers;
+
+        mJobFinished.notify_all();
+    }
+
+    mJobs.erase(std::find(mJobs.begin(), mJobs.end(), &job));
+}
+
+ThreadPool& ThreadPool::GetDefault()
+{
+    static ThreadPool pool;
+
+    return pool;
+}
+
+void ThreadPool::RunTasks(Job& job)
+{
+    unsigned int i;
+
+    while ((i = job.next++) < job.count)
+    {
+        (*job.task)(i);
+    }
+}
+
+ThreadPool::Job* ThreadPool::FindJob()
+{
+    for (Job* job : mJobs)
+    {
+        if (job->next < job->count)
+        {
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        Job* job = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+
+            mJobAvailable.wait(lock, [this, &job]() {
+                job = FindJob();
+                return mStopping || job != nullptr;
+            });
+
+            if (job == nullptr)
+            {
+                return;
+            }
+
+            ++job->activeWorkers;
+        }
+
+        RunTasks(*job);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --job->activeWorkers;
+        }
+
+        mJobFinished.notify_all();
+    }
+}
@@ -36,7 +36,7 @@ void VQModel::Init()
     }
 }
 
-void VQModel::Train(const std::vector< DynamicVector<Real> >& samples, unsigned int iterations)
+void VQModel::Train(const FrameView& samples, unsigned int iterations)
 {
     LBG lbg(GetOrder());
 
@@ -49,7 +49,7 @@ void VQModel::Train(const std::vector< DynamicVector<Real> >& samples, unsigned
     lbg.Cluster(samples, indices, mClusterCentroids, mClusterSizes);
 }
 
-void VQModel::Adapt(const std::shared_ptr<Model>& other, const std::vector< DynamicVector<Real> >& samples,
+void VQModel::Adapt(const std::shared_ptr<Model>& other, const FrameView& samples,
     unsigned int iterations, Real relevanceFactor)
 {
     const VQModel* model = dynamic_cast<VQModel*>(other.get());
@@ -63,7 +63,7 @@ void VQModel::Adapt(const std::shared_ptr<Model>& other, const std::vector< Dyna
     SetOrder(model->GetOrder());
     Init();
 
-    std::vector<unsigned int> indices(samples.size());
+    std::vector<unsigned int> indices(samples.GetFrameCount());
 
     // Initialize the feature vectors of the centroids.
 
@@ -72,25 +72,13 @@ void VQModel::Adapt(const std::shared_ptr<Model>& other, const std::vector< Dyna
         mClusterCentroids[c] = model->mClusterCentroids[c];
     }
 
+    CentroidAssignment assignment;
+
     // Do the iterations.
     for (unsigned int i = 0; i < iterations; i++)
     {
         //Find the closest centroid to each sample
-        for (unsigned int n = 0; n < samples.size(); n++)
-        {
-            Real minDist = std::numeric_limits<Real>::max();
-
-            for (unsigned int c = 0; c < GetOrder(); c++)
-            {
-                Real dist = samples[n].Distance(mClusterCentroids[c]);
-
-                if (dist < minDist)
-                {
-                    minDist = dist;
-                    indices[n] = c;
-                }
-            }
-        }
+        assignment.Assign(samples, mClusterCentroids, GetOrder(), indices);
 
         //Set the centroids to the average of the samples in each centroid
         for (unsigned int c = 0; c < GetOrder(); ++c)
@@ -100,7 +88,7 @@ void VQModel::Adapt(const std::shared_ptr<Model>& other, const std::vector< Dyna
             mClusterSizes[c] = 0;
         }
 
-        for (unsigned int s = 0; s < samples.size(); ++s)
+        for (unsigned int s = 0; s < samples.GetFrameCount(); ++s)
         {
             mClusterCentroids[indices[s]].Add(samples[s]);
 
@@ -177,25 +165,18 @@ void VQModel::Weight(const std::map< SpeakerKey, std::shared_ptr<Model> >& model
     }
 }
 
-Real VQModel::GetDistortion(const std::vector< DynamicVector<Real> >& samples) const
+Real VQModel::GetDistortion(const FrameView& samples) const
 {
-    if (mClusterSamples.size() < samples.size())
-    {
-        mClusterSamples.resize(samples.size());
-    }
-
     auto& centroids = mClusterCentroids;
     auto& sizes = mClusterSizes;
-    auto& weights = mClusterWeights;
 
-    Real dist = 0.0f;
+    Real distortion = 0.0f;
 
-    for (unsigned int s = 0; s < samples.size(); ++s)
+    for (unsigned int s = 0; s < samples.GetFrameCount(); ++s)
     {
-        auto& sample = samples[s];
+        const Real* sample = samples[s];
 
         Real minDist = std::numeric_limits<Real>::max();
-        unsigned int minC = -1;
 
         for (unsigned int c = 0; c < centroids.size(); ++c)
         {
@@ -204,47 +185,34 @@ Real VQModel::GetDistortion(const std::vector< DynamicVector<Real> >& samples) c
                 continue;
             }
 
-            dist = sample.Distance(centroids[c]);
+            Real dist = centroids[c].Distance(sample);
 
             if (dist < minDist)
             {
                 minDist = dist;
-                minC = c;
             }
         }
 
-        mClusterSamples[s] = minC;
-    }
-
-    Real distortion = 0.0f;
-
-    for (unsigned int s = 0; s < samples.size(); ++s)
-    {
-        distortion += samples[s].Distance(centroids[mClusterSamples[s]]);
+        distortion += minDist;
     }
     
     return distortion;
 }
 
-Real VQModel::GetWeightedSimilarity(const std::vector< DynamicVector<Real> >& samples) const
+Real VQModel::GetWeightedSimilarity(const FrameView& samples) const
 {
-    if (mClusterSamples.size() < samples.size())
-    {
-        mClusterSamples.resize(samples.size());
-    }
-
     auto& centroids = mClusterCentroids;
     auto& sizes = mClusterSizes;
     auto& weights = mClusterWeights;
 
-    Real dist = 0.0f;
+    Real distortion = 0.0f;
 
-    for (unsigned int s = 0; s < samples.size(); ++s)
+    for (unsigned int s = 0; s < samples.GetFrameCount(); ++s)
     {
-        auto& sample = samples[s];
+        const Real* sample = samples[s];
 
         Real minDist = std::numeric_limits<Real>::max();
-        unsigned int minC = -1;
+        unsigned int minC = 0;
 
         for (unsigned int c = 0; c < centroids.size(); ++c)
         {
@@ -253,7 +221,7 @@ Real VQModel::GetWeightedSimilarity(const std::vector< DynamicVector<Real> >& sa
                 continue;
             }
 
-            dist = sample.Distance(centroids[c]);
+            Real dist = centroids[c].Distance(sample);
 
             if (dist < minDist)
             {
@@ -262,26 +230,18 @@ Real VQModel::GetWeightedSimilarity(const std::vector< DynamicVector<Real> >& sa
             }
         }
 
-        mClusterSamples[s] = minC;
-    }
-
-    Real distortion = 0.0f;
-
-    for (unsigned int s = 0; s < samples.size(); ++s)
-    {
-        distortion += weights[mClusterSamples[s]]
-            / samples[s].Distance(centroids[mClusterSamples[s]]);
+        distortion += weights[minC] / minDist;
     }
 
-    return distortion / static_cast<Real>(samples.size());
+    return distortion / static_cast<Real>(samples.GetFrameCount());
 }
 
-Real VQModel::GetScore(const std::vector< DynamicVector<Real> >& samples) const
+Real VQModel::GetScore(const FrameView& samples, ScoringWorkspace& /*workspace*/) const
 {
     return GetWeightedSimilarity(samples);
 }
 
-Real VQModel::GetLogScore(const std::vector< DynamicVector<Real> >& samples) const
+Real VQModel::GetLogScore(const FrameView& samples, ScoringWorkspace& /*workspace*/) const
 {
     return std::log(GetWeightedSimilarity(samples));
 }
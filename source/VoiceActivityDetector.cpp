@@ -0,0 +1,164 @@
+#include "VoiceActivityDetector.h"
+
+VoiceActivityDetector::VoiceActivityDetector()
+    : mThreshold(-std::numeric_limits<Real>::infinity()),
+    mMargin(6.9), // 30 dB
+    mMinimumSnr(2.3), // 10 dB
+    mAdaptationRate(0.01),
+    mHangover(5)
+{
+    Reset();
+}
+
+VoiceActivityDetector::~VoiceActivityDetector()
+{
+
+}
+
+void VoiceActivityDetector::SetThreshold(Real threshold)
+{
+    mThreshold = threshold;
+}
+
+Real VoiceActivityDetector::GetThreshold() const
+{
+    return mThreshold;
+}
+
+void VoiceActivityDetector::SetMargin(Real margin)
+{
+    mMargin = margin;
+}
+
+Real VoiceActivityDetector::GetMargin() const
+{
+    return mMargin;
+}
+
+void VoiceActivityDetector::SetMinimumSnr(Real minimumSnr)
+{
+    mMinimumSnr = minimumSnr;
+}
+
+Real VoiceActivityDetector::GetMinimumSnr() const
+{
+    return mMinimumSnr;
+}
+
+void VoiceActivityDetector::SetAdaptationRate(Real adaptationRate)
+{
+    mAdaptationRate = adaptationRate;
+}
+
+void VoiceActivityDetector::SetHangover(unsigned int hangover)
+{
+    mHangover = hangover;
+}
+
+unsigned int VoiceActivityDetector::GetHangover() const
+{
+    return mHangover;
+}
+
+void VoiceActivityDetector::Reset()
+{
+    mPeak = -std::numeric_limits<Real>::infinity();
+    mNoise = std::numeric_limits<Real>::infinity();
+    mHangoverLeft = 0;
+}
+
+bool VoiceActivityDetector::Process(Real logEnergy)
+{
+    mPeak = Max(mPeak - mAdaptationRate, logEnergy);
+    mNoise = Min(mNoise + mAdaptationRate, logEnergy);
+
+    bool speech =  logEnergy >= mThreshold
+                && (mMinimumSnr <= 0.0 || logEnergy >= mNoise + mMinimumSnr)
+                && (mMargin <= 0.0 || logEnergy >= mPeak - mMargin);
+
+    if (speech)
+    {
+        mHangoverLeft = mHangover;
+        return true;
+    }
+
+    if (mHangoverLeft > 0)
+    {
+        --mHangoverLeft;
+        return true;
+    }
+
+    return false;
+}
+
+bool VoiceActivityDetector::Process(const Real* samples, unsigned int sampleCount)
+{
+    Real energy = 0.0;
+
+    for (unsigned int i = 0; i < sampleCount; ++i)
+    {
+        energy += samples[i] * samples[i];
+    }
+
+    if (sampleCount > 0)
+    {
+        energy /= sampleCount;
+    }
+
+    return Process(std::log(Max(energy, std::numeric_limits<Real>::min())));
+}
+
+std::vector<Real> VoiceActivityDetector::Filter(const std::vector<Real>& signal, unsigned int frameLength)
+{
+    Reset();
+
+    std::vector<Real> speech;
+    speech.reserve(signal.size());
+
+    frameLength = Max(frameLength, 1u);
+
+    for (std::size_t start = 0; start < signal.size(); start += frameLength)
+    {
+        unsigned int length = static_cast<unsigned int>(Min<std::size_t>(frameLength, signal.size() - start));
+
+        if (Process(&signal[start], length))
+        {
+            speech.insert(speech.end(), signal.begin() + start, signal.begin() + start + length);
+        }
+    }
+
+    return speech;
+}
+
+unsigned int VoiceActivityDetector::Filter(FrameMatrix& frames, unsigned int energyDimension)
+{
+    if (energyDimension >= frames.GetDimensionCount())
+    {
+        std::cout << "Voice activity detection: invalid energy dimension " << energyDimension << "." << std::endl;
+        return 0;
+    }
+
+    FrameMatrix speech(frames.GetDimensionCount());
+    speech.Reserve(frames.GetFrameCount());
+
+    for (unsigned int u = 0; u < frames.GetUtteranceCount(); ++u)
+    {
+        Reset();
+
+        speech.BeginUtterance();
+
+        for (unsigned int f = frames.GetUtteranceBegin(u); f < frames.GetUtteranceEnd(u); ++f)
+        {
+            if (Process(frames[f][energyDimension]))
+            {
+                speech.AddFrame(frames[f]);
+            }
+        }
+    }
+
+    unsigned int removed = frames.GetFrameCount() - speech.GetFrameCount();
+
+    frames = std::move(speech);
+
+    return removed;
+}
@@ -0,0 +1,201 @@
+#include "WaveFile.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    const unsigned int FORMAT_PCM = 1;
+    const unsigned int FORMAT_FLOAT = 3;
+    const unsigned int FORMAT_EXTENSIBLE = 0xFFFE;
+
+    unsigned int ReadLittleEndian(const unsigned char* bytes, unsigned int byteCount)
+    {
+        unsigned int value = 0;
+
+        for (unsigned int i = 0; i < byteCount; ++i)
+        {
+            value |= static_cast<unsigned int>(bytes[i]) << (8 * i);
+        }
+
+        return value;
+    }
+
+    /*! \brief Converts a little-endian sample to a value in the original scale.
+     */
+    Real ReadSample(const unsigned char* bytes, unsigned int format, unsigned int bitsPerSample)
+    {
+        if (format == FORMAT_FLOAT)
+        {
+            if (bitsPerSample == 32)
+            {
+                std::uint32_t bits = ReadLittleEndian(bytes, 4);
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+
+            std::uint64_t bits = ReadLittleEndian(bytes, 4) | (static_cast<std::uint64_t>(ReadLittleEndian(bytes + 4, 4)) << 32);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        // 8-bit samples are unsigned.
+        if (bitsPerSample == 8)
+        {
+            return bytes[0];
+        }
+
+        unsigned int byteCount = bitsPerSample / 8;
+        std::uint32_t bits = ReadLittleEndian(bytes, byteCount);
+
+        // Sign extension.
+        if (byteCount < 4 && (bits & (1u << (bitsPerSample - 1))))
+        {
+            bits |= ~((1u << bitsPerSample) - 1);
+        }
+
+        return static_cast<std::int32_t>(bits);
+    }
+}
+
+WaveFile::WaveFile()
+    : mSampleRate(0),
+    mChannelCount(0)
+{
+
+}
+
+WaveFile::~WaveFile()
+{
+
+}
+
+bool WaveFile::Load(const std::string& path)
+{
+    mSamples.clear();
+    mSampleRate = 0;
+    mChannelCount = 0;
+
+    std::ifstream file(path, std::ios::binary);
+
+    unsigned char header[12];
+
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header))
+        || std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 8, "WAVE", 4) != 0)
+    {
+        std::cout << "Not a WAVE file: " << path << std::endl;
+        return false;
+    }
+
+    unsigned int format = 0;
+    unsigned int bitsPerSample = 0;
+    unsigned int blockAlign = 0;
+    bool formatFound = false;
+
+    unsigned char chunkHeader[8];
+
+    while (file.read(reinterpret_cast<char*>(chunkHeader), sizeof(chunkHeader)))
+    {
+        unsigned int chunkSize = ReadLittleEndian(chunkHeader + 4, 4);
+
+        if (std::memcmp(chunkHeader, "fmt ", 4) == 0)
+        {
+            std::vector<unsigned char> chunk(chunkSize);
+
+            if (chunkSize < 16 || !file.read(reinterpret_cast<char*>(chunk.data()), chunkSize))
+            {
+                break;
+            }
+
+            format = ReadLittleEndian(&chunk[0], 2);
+            mChannelCount = ReadLittleEndian(&chunk[2], 2);
+            mSampleRate = ReadLittleEndian(&chunk[4], 4);
+            blockAlign = ReadLittleEndian(&chunk[12], 2);
+            bitsPerSample = ReadLittleEndian(&chunk[14], 2);
+
+            // The actual format is the first two bytes of the sub-format GUID.
+            if (format == FORMAT_EXTENSIBLE && chunkSize >= 26)
+            {
+                format = ReadLittleEndian(&chunk[24], 2);
+            }
+
+            formatFound = true;
+        }
+
+        else if (std::memcmp(chunkHeader, "data", 4) == 0)
+        {
+            if (!formatFound)
+            {
+                break;
+            }
+
+            bool pcm = format == FORMAT_PCM && bitsPerSample % 8 == 0 && bitsPerSample >= 8 && bitsPerSample <= 32;
+            bool floating = format == FORMAT_FLOAT && (bitsPerSample == 32 || bitsPerSample == 64);
+
+            if ((!pcm && !floating) || mChannelCount == 0 || blockAlign < mChannelCount * bitsPerSample / 8)
+            {
+                std::cout << "Unsupported WAVE format in '" << path << "': format " << format
+                    << ", " << bitsPerSample << " bits." << std::endl;
+                return false;
+            }
+
+            std::vector<unsigned char> data(chunkSize);
+            file.read(reinterpret_cast<char*>(data.data()), chunkSize);
+
+            // Truncated files are read up to the last complete frame.
+            unsigned int frameCount = file.gcount() / blockAlign;
+            unsigned int sampleBytes = bitsPerSample / 8;
+            Real invChannelCount = 1.0 / mChannelCount;
+
+            mSamples.resize(frameCount);
+
+            for (unsigned int i = 0; i < frameCount; ++i)
+            {
+                const unsigned char* frame = &data[static_cast<std::size_t>(i) * blockAlign];
+
+                Real sum = 0.0;
+
+                for (unsigned int c = 0; c < mChannelCount; ++c)
+                {
+                    sum += ReadSample(frame + c * sampleBytes, format, bitsPerSample);
+                }
+
+                mSamples[i] = (mChannelCount == 1) ? sum : sum * invChannelCount;
+            }
+
+            return true;
+        }
+
+        else
+        {
+            // Chunks are padded to an even size.
+            file.seekg(chunkSize + (chunkSize & 1), std::ios::cur);
+        }
+    }
+
+    std::cout << "Invalid WAVE file: " << path << std::endl;
+
+    return false;
+}
+
+unsigned int WaveFile::GetSampleRate() const
+{
+    return mSampleRate;
+}
+
+unsigned int WaveFile::GetChannelCount() const
+{
+    return mChannelCount;
+}
+
+Real WaveFile::GetDuration() const
+{
+    return (mSampleRate > 0) ? static_cast<Real>(mSamples.size()) / mSampleRate : 0.0;
+}
+
+const std::vector<Real>& WaveFile::GetSamples() const
+{
+    return mSamples;
+}